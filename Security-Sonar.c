@@ -18,6 +18,12 @@
  * - 1.5.0 - [15/02/2025] Implementa o Buzzer quando o status do sistema está em Alarme
  * - 1.5.1 - [15/02/2025] Modulariza o código
  * - 1.6.0 - [16/02/2025] Comentários adicionados e limpeza de código
+ * - 1.7.0 - [18/10/2026] Configuração em tempo de execução gravada na flash, alterável pela serial USB ou por UDP (escrita pela rede exige o token configurado)
+ * - 1.8.0 - [18/10/2026] Buffers de rede em pools de blocos fixos com relatório de uso de RAM
+ * - 1.9.0 - [18/10/2026] Relógio sincronizado por SNTP e instante da captura enviado com cada evento
+ * - 1.10.0 - [18/10/2026] Requisições e respostas trocadas com o contexto do lwIP por filas sem lock
+ * - 1.11.0 - [18/10/2026] Streaming das capturas (brutas ou em níveis) por TCP, sem cópia dos blocos do DMA
+ * - 1.12.0 - [18/10/2026] Detecção por cadeia DSP em C++ montada em tempo de compilação, mantendo o nível e o limiar da versão 1.x
  */
 
 #include <stdio.h>
@@ -29,9 +35,10 @@
 #include "include/mic.h"
 #include "include/buzzer.h"
 #include "include/led.h"
-
-#define WIFI_SSID       "Wedjhoze1" // Nome da rede
-#define WIFI_PASS       "43900000"  // Senha da rede
+#include "include/config.h"
+#include "include/pool.h"
+#include "include/timesync.h"
+#include "include/stream.h"
 
 #define LED_GREEN       11          // Pino do LED Verde
 #define LED_RED         13          // Pino do LED Vermelho
@@ -43,9 +50,6 @@
 #define PWM_DIVIDER     16.0        // Divisor da frequência do PWM para controle do buzzer
 #define PWM_PERIOD      4096        // Período do PWM usado para gerar sons no buzzer
 
-
-#define ROOM_ID         1           // ID da sala (esse valor foi capturado pelo servidor após criar o cômodo) 
-
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -80,13 +84,30 @@ int main()
     // A PRIXIMA LINHA DEVE SER DESCOMENTADA CASO SEJA NECESSÁRIO USAR O MONITOR SERIAL PARA DEPURAR O CÓDIGO
     // sleep_ms(5000);           // Delay para o usuário abrir o monitor serial
 
-    uint32_t interval = 1000; // Intervalo de 1 segundo que vai ser utilizado para o temporizador
+    /// Carrega a configuração da flash; daqui em diante só a cópia em RAM é consultada
+    config_init();
+    const sonar_config_t *cfg = config_get();
 
     /// Configuração do ADC
     adc_init_handler();
+    mic_set_samples(cfg->samples);
+    mic_set_threshold(cfg->threshold);
 
     /// Conecta ao Wi-Fi
-    wifi_connect(WIFI_SSID, WIFI_PASS);
+    wifi_connect(cfg->wifi_ssid, cfg->wifi_pass);
+
+    /// Permite alterar a configuração pela rede
+    config_net_init(CONFIG_NET_PORT);
+
+    /// Sincroniza o relógio para marcar os eventos com a hora UTC
+    timesync_init();
+
+    /// Telemetria do microfone para comissionamento (desligada por padrão)
+    stream_init();
+    stream_configure(cfg->stream_mode, cfg->stream_host, cfg->stream_port);
+
+    /// Mostra o orçamento de RAM (também disponível pelo comando "mem")
+    mem_report();
 
     /// Inicializa os LEDs
     init_leds();
@@ -98,26 +119,39 @@ int main()
     set_led_status(LED_GREEN, 1);
     set_led_status(LED_RED, 0);
 
-    // Define o temporizador de sistema como 10 segundos, as requisições serão enviadas a cada 10 segundos
-    absolute_time_t next_wake_time = delayed_by_us(get_absolute_time(), interval * 10000);
+    // Define o temporizador de sistema com o intervalo configurado (10 segundos por padrão)
+    absolute_time_t next_wake_time = delayed_by_ms(get_absolute_time(), cfg->interval_ms);
 
     while (true)
     {
+        // Aplica comandos de configuração recebidos pela serial ou pela rede
+        uint32_t changes = config_poll();
+        if (changes & CONFIG_CHANGED_DETECTION)
+        {
+            mic_set_samples(cfg->samples);
+            mic_set_threshold(cfg->threshold);
+        }
+        if (changes & CONFIG_CHANGED_WIFI)
+            wifi_connect(cfg->wifi_ssid, cfg->wifi_pass);
+        if (changes & CONFIG_CHANGED_STREAM)
+            stream_configure(cfg->stream_mode, cfg->stream_host, cfg->stream_port);
+
         sample_mic();
-        float avg = mic_power();
-        avg = 2.f * fabs(ADC_ADJUST(avg));
+        float avg;
+        bool detected = mic_detect(&avg);
+        mic_publish();          // Entrega o bloco ao stream; a partir daqui só `avg` é usado
 
-        if (avg > 0.1f && resposta_enviada == false)
+        if (detected && resposta_enviada == false)
         {
             // Determina o próximo status garantindo que não passe de 3
             printf("Movimento detectado: %8.4f V\n", avg);
 
             if (atualStatus == 1)
             {
-                resposta_enviada = true;
-                send_request_to_change_status(2);
-                // Espera 10 segundos
-                next_wake_time = delayed_by_us(get_absolute_time(), interval * 10000);
+                // O evento leva o instante em que o DMA terminou a captura que o detectou
+                resposta_enviada = send_request_to_change_status(2, mic_capture_time_us());
+                // Espera o intervalo configurado
+                next_wake_time = delayed_by_ms(get_absolute_time(), cfg->interval_ms);
             }
         }
 
@@ -128,9 +162,8 @@ int main()
             {
                 if (resposta_enviada == false)
                 {
-                    resposta_enviada = true;
-                    send_request_to_change_status(3);
-                    next_wake_time = delayed_by_us(next_wake_time, interval * 10000);
+                    resposta_enviada = send_request_to_change_status(3, time_us_64());
+                    next_wake_time = delayed_by_ms(next_wake_time, cfg->interval_ms);
                 }
             }
         }
@@ -150,60 +183,54 @@ int main()
             };
         }
 
-        if (is_response_complete())
+        // Resultados chegam já interpretados pelo contexto do lwIP, sem acesso ao buffer da conexão
+        http_result_t result;
+        while (wifi_poll_result(&result))
         {
-            // Procura pelo início do corpo da resposta (após o header)
-            char *body = strstr(get_response_buffer(), "\r\n\r\n");
-            if (body != NULL)
+            if (result.code == HTTP_RESULT_OPEN)
             {
-                body += 4;
-                while (*body == ' ' || *body == '\n' || *body == '\r')
-                    body++;
-
-                // Agora, compara o valor retornado
-                if (strcmp(body, "11") == 0)
-                {
-                    printf("Casa Aberta\n");
-                    set_led_status(LED_GREEN, 1);
-                    set_led_status(LED_RED, 0);
-                    atualStatus = 1;
-                }
-                else if (strcmp(body, "12") == 0)
+                printf("Casa Aberta\n");
+                set_led_status(LED_GREEN, 1);
+                set_led_status(LED_RED, 0);
+                atualStatus = 1;
+            }
+            else if (result.code == HTTP_RESULT_HUMAN)
+            {
+                printf("Mudança Humana \n");
+                set_led_status(LED_GREEN, 1);
+                set_led_status(LED_RED, 0);
+                atualStatus = 1;
+            }
+            else if (result.code == HTTP_RESULT_NOISE || result.code == HTTP_RESULT_ALARM)
+            {
+                if (result.code == HTTP_RESULT_NOISE)
                 {
-                    printf("Mudança Humana \n");
                     set_led_status(LED_GREEN, 1);
-                    set_led_status(LED_RED, 0);
-                    atualStatus = 1;
-                }
-                else if (strcmp(body, "02") == 0 || strcmp(body, "03") == 0)
-                {
-                    if (strcmp(body, "02") == 0)
-                    {
-                        set_led_status(LED_GREEN, 1);
-                        set_led_status(LED_RED, 1);
-                        atualStatus = 2;
-                    }
-                    if (strcmp(body, "03") == 0)
-                    {
-                        set_led_status(LED_GREEN, 0);
-                        set_led_status(LED_RED, 1);
-                        atualStatus = 3;
-                    }
-                    printf("Requisição bem-sucedida (retorno %s)\n", body);
+                    set_led_status(LED_RED, 1);
+                    atualStatus = 2;
                 }
-                else
+                if (result.code == HTTP_RESULT_ALARM)
                 {
-                    printf("Código desconhecido retornado: %s\n", body);
+                    set_led_status(LED_GREEN, 0);
+                    set_led_status(LED_RED, 1);
+                    atualStatus = 3;
                 }
+                printf("Requisição bem-sucedida (retorno %s)\n", result.body);
             }
-            else
+            else if (result.code == HTTP_RESULT_UNKNOWN)
+            {
+                printf("Código desconhecido retornado: %s\n", result.body);
+            }
+            else if (result.code == HTTP_RESULT_NO_BODY)
             {
                 printf("Corpo da resposta não encontrado\n");
             }
-            // Reseta o buffer e a flag para futuras requisições
-            set_response_complete(false);
+            else
+            {
+                printf("Falha na requisição\n");
+            }
+            // Libera o envio de novas requisições
             resposta_enviada = false;
-            set_response_buffer(NULL);
         }
 
         sleep_ms(100);
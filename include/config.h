@@ -0,0 +1,70 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONFIG_MAGIC                0x524E4F53u     // "SONR" em little-endian
+#define CONFIG_VERSION              1               // Versão do layout do registro gravado na flash
+
+#define CONFIG_SSID_LEN             33              // 32 caracteres + '\0'
+#define CONFIG_PASS_LEN             64              // 63 caracteres + '\0'
+#define CONFIG_URL_LEN              64              // Host do servidor + '\0'
+#define CONFIG_TOKEN_LEN            32              // Token dos comandos pela rede: 31 caracteres + '\0'
+
+// Valores usados quando não existe registro válido na flash
+#define CONFIG_DEFAULT_WIFI_SSID    "Wedjhoze1"
+#define CONFIG_DEFAULT_WIFI_PASS    "43900000"
+#define CONFIG_DEFAULT_SERVER_URL   "embarcatech.icy-tree-310a.workers.dev"
+#define CONFIG_DEFAULT_ROOM_ID      1
+#define CONFIG_DEFAULT_THRESHOLD    0.1f            // Limiar de detecção em volts (2 x |RMS - 1,65 V|)
+#define CONFIG_DEFAULT_INTERVAL_MS  10000           // Intervalo de escalonamento do status
+#define CONFIG_DEFAULT_SAMPLES      200             // Amostras por captura: 50, 100 ou 200 (ver dsp_block_size())
+#define CONFIG_DEFAULT_STREAM_MODE  0               // STREAM_MODE_OFF
+#define CONFIG_DEFAULT_STREAM_HOST  ""              // Receptor da telemetria (vazio = desligado)
+#define CONFIG_DEFAULT_STREAM_PORT  5005
+#define CONFIG_DEFAULT_NET_TOKEN    ""              // Sem token a porta UDP só aceita get e mem
+
+#define CONFIG_NET_PORT             4242            // Porta UDP para atualização da configuração pela rede
+#define CONFIG_REPLY_SIZE           1024            // Maior resposta enviada a um comando recebido por UDP
+
+// Máscara retornada por config_poll() indicando o que precisa ser reaplicado. Servidor e
+// sala não têm bit: src/wifi.c lê server_url e room_id a cada requisição.
+#define CONFIG_CHANGED_WIFI         (1u << 0)
+#define CONFIG_CHANGED_DETECTION    (1u << 1)
+#define CONFIG_CHANGED_STREAM       (1u << 2)
+
+/**
+ * @brief Registro de configuração persistido no último setor da flash.
+ *
+ * O campo `crc` cobre todos os bytes anteriores a ele. Qualquer mudança no
+ * layout deve incrementar CONFIG_VERSION.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;                            // sizeof(sonar_config_t) no momento da gravação
+    char     wifi_ssid[CONFIG_SSID_LEN];
+    char     wifi_pass[CONFIG_PASS_LEN];
+    char     server_url[CONFIG_URL_LEN];
+    uint16_t room_id;
+    uint16_t samples;
+    uint32_t interval_ms;
+    float    threshold;
+    char     stream_host[CONFIG_URL_LEN];
+    uint16_t stream_port;
+    uint8_t  stream_mode;
+    char     net_token[CONFIG_TOKEN_LEN];       // Vazio = rede só leitura
+    uint32_t crc;
+} sonar_config_t;
+
+void config_init();
+const sonar_config_t *config_get();
+bool config_set(const char *key, const char *value);
+bool config_save();
+void config_reset();
+bool config_handle_command(const char *line);
+void config_net_init(uint16_t port);
+uint32_t config_poll();
+
+#endif
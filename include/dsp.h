@@ -0,0 +1,21 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_MIN_BLOCK       50              // Menor captura suportada pela cadeia do firmware
+
+unsigned dsp_block_size(unsigned samples);
+void dsp_set_threshold(float volts);
+bool dsp_detect(const uint16_t *samples, unsigned count, float *level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef DSP_PIPELINE_HPP
+#define DSP_PIPELINE_HPP
+
+/**
+ * @file dsp_pipeline.hpp
+ * @brief Cadeia de processamento do microfone montada em tempo de compilação.
+ *
+ * Uma cadeia é `dsp::pipeline<Formato, Bloco, TaxaHz, Estágios...>`. O formato define
+ * o tipo da amostra e o tipo de trabalho (inteiro para o ADC, float no host); o tamanho
+ * do bloco e a taxa são propagados de um estágio ao seguinte (o decimador os divide), de
+ * modo que cada laço tem contagem fixa e nenhum desvio dependente dos dados. Não há
+ * alocação nem funções virtuais: o compilador expande a cadeia inteira em process().
+ *
+ * Estágios de bloco (recebem e devolvem std::array): dc_blocker, decimator.
+ * Redutores (bloco -> potência média em unidades²): rms, band_energy, legacy_level.
+ * Final (potência -> detection): detector.
+ *
+ * Exemplo de cadeia que mede só a parte AC do sinal (o firmware usa legacy_level, ver
+ * src/dsp.cpp):
+ * @code
+ * using chain = dsp::pipeline<dsp::adc12, 200, MIC_SAMPLE_RATE_HZ,
+ *                             dsp::decimator<2>, dsp::dc_blocker<7>, dsp::rms, dsp::detector<>>;
+ * @endcode
+ *
+ * Só depende da biblioteca padrão; compila no firmware e em tools/bench.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2025
+ */
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace dsp {
+
+// --------------------------------------------------------------------------------------
+// Formatos de amostra
+// --------------------------------------------------------------------------------------
+
+/// Amostras de 12 bits do ADC do RP2040, centradas em 2048 e processadas em inteiros.
+struct adc12 {
+    using sample_type = uint16_t;
+    using work_type   = int32_t;
+    using acc_type    = int64_t;
+    static constexpr float volts_per_unit = 3.3f / 4096.f;
+    static constexpr work_type midscale = 2048;                 // Valor bruto do meio da escala (1,65 V)
+    static constexpr work_type to_work(sample_type s) { return static_cast<work_type>(s & 0x0FFFu) - midscale; }
+};
+
+/// Amostras com sinal em Q15 (±1,65 V em fundo de escala).
+struct q15 {
+    using sample_type = int16_t;
+    using work_type   = int32_t;
+    using acc_type    = int64_t;
+    static constexpr float volts_per_unit = 1.65f / 32768.f;
+    static constexpr work_type midscale = 0;
+    static constexpr work_type to_work(sample_type s) { return s; }
+};
+
+/// Amostras em volts, já centradas; exige ponto flutuante (software no Cortex-M0+).
+struct f32 {
+    using sample_type = float;
+    using work_type   = float;
+    using acc_type    = float;
+    static constexpr float volts_per_unit = 1.f;
+    static constexpr work_type midscale = 0;
+    static constexpr work_type to_work(sample_type s) { return s; }
+};
+
+/// Saída do detector.
+struct detection {
+    float power;                                // Potência média do bloco, em unidades² do formato
+    bool  active;
+};
+
+namespace detail {
+
+/// Cosseno avaliável em tempo de compilação (série de Taylor após reduzir para [-pi, pi]).
+constexpr double cos(double x) {
+    constexpr double pi = 3.14159265358979323846;
+    while (x > pi)
+        x -= 2.0 * pi;
+    while (x < -pi)
+        x += 2.0 * pi;
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 24; ++n) {
+        term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr unsigned log2(std::size_t value) {
+    unsigned bits = 0;
+    while (value > 1) {
+        value >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+template <typename Format>
+constexpr bool is_float = std::is_floating_point<typename Format::work_type>::value;
+
+/**
+ * @brief Encadeamento recursivo: cada nível guarda um estágio já especializado para
+ * o tamanho e a taxa que recebe, e o restante da cadeia para o que ele produz.
+ */
+template <typename Format, std::size_t N, uint32_t Rate, typename... Stages>
+struct chain {
+    // Fim da cadeia: referências (blocos) passam adiante, valores (potência, detection) são copiados
+    template <typename Signal>
+    Signal run(Signal &&signal) { return static_cast<Signal &&>(signal); }
+};
+
+template <typename Format, std::size_t N, uint32_t Rate, typename Stage, typename... Rest>
+struct chain<Format, N, Rate, Stage, Rest...> {
+    using stage_type = typename Stage::template bind<Format, N, Rate>;
+
+    stage_type stage;
+    chain<Format, stage_type::out_size, stage_type::out_rate, Rest...> rest;
+
+    template <typename Signal>
+    decltype(auto) run(Signal &&signal) { return rest.run(stage(signal)); }
+
+    template <std::size_t I>
+    auto &get() {
+        if constexpr (I == 0)
+            return stage;
+        else
+            return rest.template get<I - 1>();
+    }
+};
+
+} // namespace detail
+
+// --------------------------------------------------------------------------------------
+// Estágios
+// --------------------------------------------------------------------------------------
+
+/**
+ * @brief Remove o nível DC: y[n] = x[n] - x[n-1] + p * y[n-1], com p = 1 - 2^-PoleShift.
+ *
+ * A versão inteira guarda o acumulador com 8 bits fracionários para que o truncamento
+ * não deixe um resíduo DC de até 2^PoleShift unidades. O estado segue de um bloco para
+ * o outro.
+ */
+template <unsigned PoleShift = 7>
+struct dc_blocker {
+    template <typename Format, std::size_t N, uint32_t Rate>
+    struct bind {
+        using work = typename Format::work_type;
+        static constexpr std::size_t out_size = N;
+        static constexpr uint32_t out_rate = Rate;
+        static constexpr unsigned frac_bits = 8;
+
+        work last_input = 0;
+        work acc = 0;                           // y[n-1] (com frac_bits no caso inteiro)
+
+        std::array<work, N> &operator()(std::array<work, N> &x) {
+            work previous = last_input, y = acc;
+            for (std::size_t i = 0; i < N; ++i) {
+                work input = x[i];
+                if constexpr (detail::is_float<Format>) {
+                    y = input - previous + y - y * (work(1) / work(1u << PoleShift));
+                    x[i] = y;
+                } else {
+                    y = y - (y >> PoleShift) + (input - previous) * work(1 << frac_bits);
+                    x[i] = y >> frac_bits;
+                }
+                previous = input;
+            }
+            last_input = previous;
+            acc = y;
+            return x;
+        }
+    };
+};
+
+/**
+ * @brief Média de Factor amostras consecutivas (CIC de 1ª ordem); divide bloco e taxa.
+ */
+template <std::size_t Factor>
+struct decimator {
+    template <typename Format, std::size_t N, uint32_t Rate>
+    struct bind {
+        static_assert(Factor > 0 && N % Factor == 0, "o bloco deve ser múltiplo do fator de decimação");
+        using work = typename Format::work_type;
+        static constexpr std::size_t out_size = N / Factor;
+        static constexpr uint32_t out_rate = Rate / Factor;
+
+        std::array<work, out_size> out;
+
+        std::array<work, out_size> &operator()(const std::array<work, N> &x) {
+            for (std::size_t o = 0; o < out_size; ++o) {
+                work sum = 0;
+                for (std::size_t k = 0; k < Factor; ++k)
+                    sum += x[o * Factor + k];
+                if constexpr (detail::is_float<Format>)
+                    out[o] = sum * (work(1) / work(Factor));
+                else if constexpr ((Factor & (Factor - 1)) == 0)
+                    out[o] = sum >> detail::log2(Factor);
+                else
+                    out[o] = sum / static_cast<work>(Factor);
+            }
+            return out;
+        }
+    };
+};
+
+/**
+ * @brief Potência média do bloco (o quadrado do valor RMS), em unidades² do formato.
+ *
+ * A raiz fica para quem for exibir o valor; o detector compara potências.
+ */
+struct rms {
+    template <typename Format, std::size_t N, uint32_t Rate>
+    struct bind {
+        using work = typename Format::work_type;
+        using acc_type = typename Format::acc_type;
+        static constexpr std::size_t out_size = 1;
+        static constexpr uint32_t out_rate = Rate / N;
+
+        float operator()(const std::array<work, N> &x) {
+            acc_type acc = 0;
+            for (std::size_t i = 0; i < N; ++i)
+                acc += static_cast<acc_type>(x[i] * x[i]);
+            return static_cast<float>(acc) * (1.f / N);
+        }
+    };
+};
+
+/**
+ * @brief Potência na raia de CenterHz (algoritmo de Goertzel), na mesma escala de rms.
+ *
+ * A raia é a mais próxima de CenterHz para o bloco e a taxa recebidos; o coeficiente é
+ * calculado em tempo de compilação (Q14 no caso inteiro).
+ */
+template <uint32_t CenterHz>
+struct band_energy {
+    template <typename Format, std::size_t N, uint32_t Rate>
+    struct bind {
+        using work = typename Format::work_type;
+        using acc_type = typename Format::acc_type;
+        static constexpr std::size_t out_size = 1;
+        static constexpr uint32_t out_rate = Rate / N;
+        static constexpr std::size_t bin = (static_cast<uint64_t>(N) * CenterHz + Rate / 2) / Rate;
+        static_assert(bin >= 1 && bin < N / 2, "CenterHz fora da faixa do bloco");
+        static constexpr double coef = 2.0 * detail::cos(2.0 * 3.14159265358979323846 * bin / N);
+        static constexpr int32_t coef_q14 = static_cast<int32_t>(coef * 16384.0 + (coef >= 0 ? 0.5 : -0.5));
+
+        float operator()(const std::array<work, N> &x) {
+            acc_type s1 = 0, s2 = 0;
+            for (std::size_t i = 0; i < N; ++i) {
+                acc_type s;
+                if constexpr (detail::is_float<Format>)
+                    s = x[i] + static_cast<acc_type>(coef) * s1 - s2;
+                else
+                    s = x[i] + ((coef_q14 * s1) >> 14) - s2;
+                s2 = s1;
+                s1 = s;
+            }
+            float a = static_cast<float>(s1), b = static_cast<float>(s2);
+            float magnitude = a * a + b * b - static_cast<float>(coef) * a * b;
+            return magnitude * (2.f / (static_cast<float>(N) * N));
+        }
+    };
+};
+
+/**
+ * @brief Métrica da versão 1.x: (RMS das amostras brutas - meio da escala)², em unidades².
+ *
+ * O RMS inclui o DC do microfone (o meio da escala é somado de volta), como fazia o laço
+ * original; 2 x raiz da saída x volts_per_unit é exatamente 2 x |RMS x 3,3 / 4096 - 1,65|
+ * no adc12. Mantém o significado dos limiares já gravados, ao custo de uma raiz por bloco.
+ */
+struct legacy_level {
+    template <typename Format, std::size_t N, uint32_t Rate>
+    struct bind {
+        using work = typename Format::work_type;
+        using acc_type = typename Format::acc_type;
+        static constexpr std::size_t out_size = 1;
+        static constexpr uint32_t out_rate = Rate / N;
+
+        float operator()(const std::array<work, N> &x) {
+            acc_type acc = 0;
+            for (std::size_t i = 0; i < N; ++i) {
+                acc_type raw = static_cast<acc_type>(x[i]) + Format::midscale;
+                acc += raw * raw;
+            }
+            float deviation = std::sqrt(static_cast<float>(acc) * (1.f / N)) - static_cast<float>(Format::midscale);
+            return deviation * deviation;
+        }
+    };
+};
+
+/**
+ * @brief Compara a potência com o limiar; desativa abaixo de ReleasePercent% dele.
+ *
+ * Com ReleasePercent = 100 (padrão) não há histerese. Antes de set_threshold() o
+ * detector nunca dispara.
+ */
+template <unsigned ReleasePercent = 100>
+struct detector {
+    template <typename Format, std::size_t N, uint32_t Rate>
+    struct bind {
+        static_assert(N == 1, "o detector recebe a saída de um redutor (rms, band_energy, legacy_level)");
+        static_assert(ReleasePercent > 0 && ReleasePercent <= 100, "ReleasePercent deve estar em 1..100");
+        static constexpr std::size_t out_size = 1;
+        static constexpr uint32_t out_rate = Rate;
+
+        float on = 3.4e38f;
+        float off = 3.4e38f;
+        bool active = false;
+
+        void set_threshold(float power) {
+            on = power;
+            off = power * (ReleasePercent / 100.f);
+        }
+
+        detection operator()(float power) {
+            active = (power > on) | (active & (power > off));
+            return { power, active };
+        }
+    };
+};
+
+// --------------------------------------------------------------------------------------
+// Cadeia
+// --------------------------------------------------------------------------------------
+
+/**
+ * @brief Cadeia completa para blocos de N amostras em Format, a RateHz.
+ *
+ * process() converte o bloco para o tipo de trabalho e o passa por todos os estágios,
+ * devolvendo a saída do último (um dsp::detection quando termina em detector).
+ */
+template <typename Format, std::size_t N, uint32_t RateHz, typename... Stages>
+class pipeline {
+public:
+    using format = Format;
+    using sample_type = typename Format::sample_type;
+    using work_type = typename Format::work_type;
+    static constexpr std::size_t block_size = N;
+    static constexpr uint32_t sample_rate = RateHz;
+
+    static_assert(N > 0, "bloco vazio");
+
+    decltype(auto) process(const sample_type *samples) {
+        for (std::size_t i = 0; i < N; ++i)
+            work_[i] = Format::to_work(samples[i]);
+        return chain_.run(work_);
+    }
+
+    /// Acesso ao I-ésimo estágio (por exemplo, para ajustar o limiar do detector).
+    template <std::size_t I>
+    auto &stage() { return chain_.template get<I>(); }
+
+    /// Potência (unidades²) de um sinal com `volts` volts RMS, para set_threshold().
+    static constexpr float power_from_volts(float volts) {
+        float units = volts / Format::volts_per_unit;
+        return units * units;
+    }
+
+private:
+    std::array<work_type, N> work_{};
+    detail::chain<Format, N, RateHz, Stages...> chain_;
+};
+
+} // namespace dsp
+
+#endif
@@ -8,12 +8,15 @@
 #define MIC_CHANNEL         2
 #define MIC_PIN             (26 + MIC_CHANNEL)
 #define ADC_CLOCK_DIV       96.f
-#define SAMPLES             200
-#define ADC_ADJUST(x)       (x * 3.3f / (1 << 12u) - 1.65f)
-#define LIMIAR_DECIBEIS     0.5f
+#define SAMPLES             200             // Capacidade do buffer; a quantidade usada vem da configuração
+#define MIC_SAMPLE_RATE_HZ  (48000000u / (1u + (uint32_t)ADC_CLOCK_DIV))   // Uma conversão a cada 1 + div ciclos de clk_adc
 
 void adc_init_handler();
 void sample_mic();
-float mic_power();
+bool mic_detect(float *level);
+void mic_set_threshold(float volts);
+void mic_publish();
+void mic_set_samples(uint samples);
+uint64_t mic_capture_time_us();
 
 #endif
@@ -0,0 +1,61 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define MEM_SRAM_BYTES          (264 * 1024)    // SRAM total do RP2040
+#define MEM_MAX_REGIONS         12              // Regiões estáticas registradas em mem_register()
+
+/**
+ * @brief Pool de blocos de tamanho fixo.
+ *
+ * O armazenamento é reservado em tempo de compilação por POOL_DEFINE(); não há
+ * alocação dinâmica. Alocar e liberar custam O(1) e podem ser chamados tanto do laço
+ * principal quanto dos callbacks do lwIP.
+ */
+typedef struct pool {
+    const char  *subsystem;         // Dono do pool, usado em mem_report()
+    const char  *name;
+    uint8_t     *storage;
+    uint16_t     block_size;        // Já arredondado para múltiplo de 4
+    uint16_t     block_count;
+    void        *free_list;         // Blocos livres encadeados pela primeira palavra
+    uint16_t     in_use;
+    uint16_t     high_water;        // Maior valor de in_use desde o boot
+    uint32_t     failures;          // Alocações recusadas por falta de bloco
+    bool         initialized;
+    struct pool *next;              // Lista de pools registrados para o relatório
+} pool_t;
+
+#define POOL_BLOCK_SIZE(size)   ((((size) + 3u) / 4u) * 4u)
+
+/**
+ * @brief Declara um pool com `count` blocos de `size` bytes.
+ *
+ * Exemplo: `POOL_DEFINE(request_pool, "wifi", "http_req", 512, 2);`
+ */
+#define POOL_DEFINE(var, subsys, label, size, count)                                        \
+    _Static_assert((size) >= sizeof(void *) && POOL_BLOCK_SIZE(size) <= UINT16_MAX, "tamanho de bloco inválido"); \
+    _Static_assert((count) > 0 && (count) <= UINT16_MAX, "quantidade de blocos inválida");  \
+    static uint32_t var##_storage[(count) * POOL_BLOCK_SIZE(size) / 4u];                     \
+    static pool_t var = {                                                                    \
+        .subsystem   = (subsys),                                                             \
+        .name        = (label),                                                              \
+        .storage     = (uint8_t *)var##_storage,                                             \
+        .block_size  = POOL_BLOCK_SIZE(size),                                                \
+        .block_count = (count),                                                              \
+    }
+
+void pool_init(pool_t *pool);
+void *pool_alloc(pool_t *pool);
+void pool_free(pool_t *pool, void *block);
+/// Função no formato de printf usada por mem_report_to() para cada linha do relatório.
+typedef int (*mem_print_fn)(const char *format, ...);
+
+void mem_register(const char *subsystem, const char *name, size_t bytes);
+void mem_report();
+void mem_report_to(mem_print_fn print);
+
+#endif
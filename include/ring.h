@@ -0,0 +1,41 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Fila circular sem lock para um produtor e um consumidor.
+ *
+ * Usada na fronteira entre o contexto do lwIP (interrupção de baixa prioridade do
+ * CYW43) e o laço principal. Cada lado escreve apenas o próprio índice; a ordem entre
+ * o conteúdo do slot e o índice é garantida por barreiras acquire/release.
+ */
+typedef struct {
+    uint8_t  *slots;
+    uint16_t  slot_size;
+    uint16_t  capacity;         // Potência de 2
+    uint32_t  head;             // Próxima escrita, alterado só pelo produtor
+    uint32_t  tail;             // Próxima leitura, alterado só pelo consumidor
+    uint32_t  dropped;          // Itens recusados com a fila cheia (produtor)
+} ring_t;
+
+/**
+ * @brief Declara uma fila com `count` elementos do tipo `type`.
+ *
+ * Exemplo: `RING_DEFINE(result_ring, http_result_t, 4);`
+ */
+#define RING_DEFINE(var, type, count)                                                       \
+    _Static_assert((count) > 0 && ((count) & ((count) - 1)) == 0, "capacidade deve ser potência de 2"); \
+    static type var##_slots[count];                                                          \
+    static ring_t var = {                                                                    \
+        .slots     = (uint8_t *)var##_slots,                                                 \
+        .slot_size = sizeof(type),                                                           \
+        .capacity  = (count),                                                                \
+    }
+
+bool ring_push(ring_t *ring, const void *item);
+bool ring_pop(ring_t *ring, void *item);
+bool ring_is_empty(ring_t *ring);
+
+#endif
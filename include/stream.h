@@ -0,0 +1,58 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "include/mic.h"
+
+#define STREAM_MAGIC            0x5453524Eu     // "NRST" em little-endian
+#define STREAM_FRAMES           8               // Blocos de captura: 1 sendo preenchido pelo DMA + até 7 em trânsito
+#define STREAM_LEVEL_DECIMATION 10              // Amostras agregadas em cada nível RMS do modo "level"
+#define STREAM_RETRY_MS         2000            // Intervalo mínimo entre tentativas de reconexão
+
+/// Modo do streaming de telemetria, gravado na configuração.
+typedef enum {
+    STREAM_MODE_OFF   = 0,                      // Nenhum bloco é enviado
+    STREAM_MODE_RAW   = 1,                      // Cada captura completa do ADC (12 bits em 16)
+    STREAM_MODE_LEVEL = 2,                      // Níveis RMS a cada STREAM_LEVEL_DECIMATION amostras
+} stream_mode_t;
+
+/// Tipo do frame indicado no cabeçalho.
+#define STREAM_FRAME_RAW        1
+#define STREAM_FRAME_LEVEL      2
+
+/**
+ * @brief Cabeçalho enviado antes dos valores de cada captura (32 bytes, little-endian).
+ *
+ * `sequence` é incrementado em toda captura, inclusive nas descartadas, para que o
+ * receptor detecte lacunas mesmo sem olhar `dropped`.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t  type;                              // STREAM_FRAME_RAW ou STREAM_FRAME_LEVEL
+    uint8_t  decimation;                        // Amostras por valor (1 nos frames brutos)
+    uint16_t count;                             // Valores de 16 bits após o cabeçalho
+    uint32_t sequence;
+    uint32_t dropped;                           // Capturas descartadas por falta de bloco desde o boot
+    uint64_t capture_us;                        // time_us_64() no fim do DMA
+    uint64_t epoch_ms;                          // Mesmo instante em UTC; 0 antes do SNTP
+} stream_header_t;
+
+/**
+ * @brief Bloco de captura: o DMA escreve em `samples` e o bloco inteiro é entregue ao
+ * tcp_write sem cópia, até o tcp_sent confirmar todos os seus bytes.
+ */
+typedef struct {
+    stream_header_t header;
+    uint16_t samples[SAMPLES];
+} stream_frame_t;
+
+_Static_assert(sizeof(stream_header_t) == 32, "cabeçalho do stream deve ter 32 bytes");
+
+void stream_init();
+void stream_configure(uint8_t mode, const char *host, uint16_t port);
+stream_frame_t *stream_acquire();
+void stream_submit(stream_frame_t *frame, uint count, uint64_t capture_us);
+
+#endif
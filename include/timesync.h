@@ -0,0 +1,19 @@
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMESYNC_SERVER     "pool.ntp.org"      // Servidor SNTP consultado após conectar ao Wi-Fi
+#define TIMESYNC_SLEW_PPM   500                 // Velocidade máxima da correção gradual (µs por segundo)
+#define TIMESYNC_STEP_US    1000000u            // Atraso acima do qual o relógio salta para frente
+#define TIMESYNC_STEP_BACK_US 1000000u          // Adiantamento acima do qual o relógio salta para trás (2000 s de correção gradual)
+
+void timesync_init();
+bool timesync_is_synced();
+uint64_t timesync_now_us();
+uint64_t timesync_to_epoch_ms(uint64_t monotonic_us);
+void timesync_set_system_time(uint32_t sec, uint32_t us);
+void timesync_get_system_time(uint32_t *sec, uint32_t *us);
+
+#endif
@@ -6,15 +6,28 @@
 #include "pico/cyw43_arch.h"
 #include "lwip/tcp.h"
 
-#define SERVER_URL "embarcatech.icy-tree-310a.workers.dev"
+#define HTTP_BODY_SIZE      8           // Corpo da resposta repassado ao laço principal ("11", "02"...)
 
-void wifi_connect(char *ssid, char *pass);
-void send_custom_http_request(const char *method, const char *endpoint, const char *body);
-bool is_response_complete();
-char *get_response_buffer();
-char *set_response_buffer(char *buffer);
-void set_response_complete(bool status);
+/// Resultado de uma requisição, já interpretado no contexto do lwIP.
+typedef enum {
+    HTTP_RESULT_OPEN,                   // "11": casa aberta
+    HTTP_RESULT_HUMAN,                  // "12": mudança humana
+    HTTP_RESULT_NOISE,                  // "02": status alterado para Barulho
+    HTTP_RESULT_ALARM,                  // "03": status alterado para Alarme
+    HTTP_RESULT_UNKNOWN,                // Corpo com outro código
+    HTTP_RESULT_NO_BODY,                // Resposta sem o fim dos cabeçalhos
+    HTTP_RESULT_FAILED,                 // Falha de DNS, conexão ou falta de blocos
+} http_result_code_t;
+
+typedef struct {
+    http_result_code_t code;
+    char body[HTTP_BODY_SIZE];          // Início do corpo, terminado em '\0'
+} http_result_t;
+
+void wifi_connect(const char *ssid, const char *pass);
+bool send_custom_http_request(const char *method, const char *endpoint, const char *body);
+bool wifi_poll_result(http_result_t *result);
 void wifi_cleanup();
-void send_request_to_change_status(int status);
+bool send_request_to_change_status(int status, uint64_t captured_us);
 
-#endif
\ No newline at end of file
+#endif
@@ -21,13 +21,19 @@
 #define MEM_ALIGNMENT               4
 #define MEM_SIZE                    4000
 #define MEMP_NUM_TCP_SEG            32
+// O stream (src/stream.c) entrega cada bloco ao tcp_write sem cópia, ocupando um pbuf
+// PBUF_ROM por bloco em trânsito (STREAM_FRAMES) até a confirmação; do heap (MEM_SIZE)
+// sai só o pbuf de cabeçalho de cada segmento
+#define MEMP_NUM_PBUF               16
 #define MEMP_NUM_ARP_QUEUE          10
-#define PBUF_POOL_SIZE              24
+// O firmware recebe apenas respostas HTTP curtas; 16 pbufs cobrem a janela de 4 segmentos
+// com folga para o tráfego do CYW43 (ver o comando "mem" para o consumo real)
+#define PBUF_POOL_SIZE              16
 #define LWIP_ARP                    1
 #define LWIP_ETHERNET               1
 #define LWIP_ICMP                   1
 #define LWIP_RAW                    1
-#define TCP_WND                     (8 * TCP_MSS)
+#define TCP_WND                     (4 * TCP_MSS)
 #define TCP_MSS                     1460
 #define TCP_SND_BUF                 (8 * TCP_MSS)
 #define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
@@ -35,9 +41,7 @@
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
-#define MEM_STATS                   0
 #define SYS_STATS                   0
-#define MEMP_STATS                  0
 #define LINK_STATS                  0
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM       3
@@ -47,14 +51,34 @@
 #define LWIP_UDP                    1
 #define LWIP_DNS                    1
 #define LWIP_TCP_KEEPALIVE          1
-#define LWIP_NETIF_TX_SINGLE_PBUF   1
+// Com 1 o tcp_write força TCP_WRITE_FLAG_COPY e os blocos do stream seriam copiados
+// para o heap; o linkoutput do CYW43 aceita cadeias de pbufs (copia cada uma para o SPI)
+#define LWIP_NETIF_TX_SINGLE_PBUF   0
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
+// SNTP (pico_lwip_sntp): a hora recebida ajusta o relógio de src/timesync.c
+#define SNTP_SERVER_DNS             1
+#define SNTP_COMP_ROUNDTRIP         1
+#define SNTP_UPDATE_DELAY           64000       // Consulta a cada 64 s (minpoll do NTP) em vez de 1 hora
+#define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 1)
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+void timesync_set_system_time(uint32_t sec, uint32_t us);
+void timesync_get_system_time(uint32_t *sec, uint32_t *us);
+#endif
+#define SNTP_SET_SYSTEM_TIME_US(sec, us)    timesync_set_system_time((sec), (us))
+#define SNTP_GET_SYSTEM_TIME(sec, us)       timesync_get_system_time(&(sec), &(us))
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
 #define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
+#define MEM_STATS                   1
+#define MEMP_STATS                  1
+#else
+#define MEM_STATS                   0
+#define MEMP_STATS                  0
 #endif
 
 #define ETHARP_DEBUG                LWIP_DBG_OFF
@@ -0,0 +1,453 @@
+/**
+ * @file config.c
+ * @brief Implementação do armazenamento da configuração em tempo de execução.
+ *
+ * A configuração (credenciais do Wi-Fi, sala, servidor e parâmetros de detecção) fica
+ * gravada no último setor da flash como um registro versionado e protegido por CRC32.
+ * Ela é lida uma única vez no boot para uma cópia em RAM, que é a única fonte consultada
+ * pelo restante do firmware. Alterações chegam pela serial USB ou por UDP e são aplicadas
+ * sem reiniciar a placa.
+ *
+ * Pela rede, `get` e `mem` são sempre aceitos e respondidos ao remetente. Os comandos
+ * que alteram a configuração só são executados quando o datagrama começa com o token
+ * gravado (`<token> set room 3`); sem token configurado a porta UDP é somente leitura.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/udp.h"
+
+#include "include/config.h"
+#include "include/mic.h"
+#include "include/pool.h"
+#include "include/ring.h"
+#include "include/stream.h"
+#include "include/dsp.h"
+
+#define CONFIG_FLASH_OFFSET     (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)    // Último setor da flash
+#define CONFIG_LINE_SIZE        128                                            // Tamanho máximo de um comando
+#define CONFIG_RECORD_BYTES     ((sizeof(sonar_config_t) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE)
+
+_Static_assert(CONFIG_RECORD_BYTES <= FLASH_SECTOR_SIZE, "sonar_config_t deve caber no setor de configuração");
+_Static_assert(CONFIG_DEFAULT_SAMPLES <= SAMPLES, "CONFIG_DEFAULT_SAMPLES excede o buffer do ADC");
+
+static sonar_config_t config;                           // Cópia em RAM lida pelos caminhos críticos.
+static uint32_t pending_changes = 0;                    // Alterações ainda não informadas por config_poll().
+
+static char serial_line[CONFIG_LINE_SIZE];              // Linha sendo recebida pela serial USB.
+static uint serial_length = 0;                          // Quantidade de caracteres em serial_line.
+
+/// Comando recebido por UDP, copiado do contexto do lwIP para o laço principal.
+typedef struct {
+    char      text[CONFIG_LINE_SIZE];
+    ip_addr_t addr;                                     // Remetente, que recebe a resposta
+    u16_t     port;
+} config_line_t;
+
+RING_DEFINE(net_ring, config_line_t, 2);                // Comandos recebidos por UDP ainda não processados.
+static struct udp_pcb *config_pcb = NULL;               // PCB do listener UDP.
+
+static char reply[CONFIG_REPLY_SIZE];                   // Resposta do comando de rede em execução.
+static size_t reply_length = 0;
+static bool reply_to_net = false;                       // true enquanto um comando de rede é executado.
+
+/**
+ * @brief Calcula o CRC32 (polinômio 0xEDB88320) de um bloco de memória.
+ *
+ * Só é usado no boot e ao gravar, então a versão bit a bit, sem tabela, é suficiente.
+ *
+ * @param data Dados de entrada.
+ * @param length Quantidade de bytes.
+ * @return CRC32 calculado.
+ */
+static uint32_t config_crc32(const uint8_t *data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Calcula o CRC de um registro, cobrindo todos os campos anteriores ao `crc`.
+ */
+static uint32_t config_record_crc(const sonar_config_t *cfg) {
+    return config_crc32((const uint8_t *)cfg, offsetof(sonar_config_t, crc));
+}
+
+/**
+ * @brief Copia uma string para um campo de tamanho fixo.
+ * @return false se o valor não couber no campo (nada é alterado).
+ */
+static bool config_copy_string(char *dest, size_t size, const char *value) {
+    size_t length = strlen(value);
+    if (length >= size)
+        return false;
+    memset(dest, 0, size);
+    memcpy(dest, value, length);
+    return true;
+}
+
+/**
+ * @brief Restaura os valores padrão na cópia em RAM (a flash não é alterada).
+ */
+void config_reset() {
+    memset(&config, 0, sizeof(config));
+    config.magic       = CONFIG_MAGIC;
+    config.version     = CONFIG_VERSION;
+    config.length      = sizeof(sonar_config_t);
+    config_copy_string(config.wifi_ssid, sizeof(config.wifi_ssid), CONFIG_DEFAULT_WIFI_SSID);
+    config_copy_string(config.wifi_pass, sizeof(config.wifi_pass), CONFIG_DEFAULT_WIFI_PASS);
+    config_copy_string(config.server_url, sizeof(config.server_url), CONFIG_DEFAULT_SERVER_URL);
+    config.room_id     = CONFIG_DEFAULT_ROOM_ID;
+    config.samples     = CONFIG_DEFAULT_SAMPLES;
+    config.interval_ms = CONFIG_DEFAULT_INTERVAL_MS;
+    config.threshold   = CONFIG_DEFAULT_THRESHOLD;
+    config_copy_string(config.stream_host, sizeof(config.stream_host), CONFIG_DEFAULT_STREAM_HOST);
+    config.stream_port = CONFIG_DEFAULT_STREAM_PORT;
+    config.stream_mode = CONFIG_DEFAULT_STREAM_MODE;
+    config_copy_string(config.net_token, sizeof(config.net_token), CONFIG_DEFAULT_NET_TOKEN);
+    pending_changes |= CONFIG_CHANGED_WIFI | CONFIG_CHANGED_DETECTION | CONFIG_CHANGED_STREAM;
+}
+
+/**
+ * @brief Carrega a configuração da flash para a RAM.
+ *
+ * O registro só é aceito se magic, versão, tamanho e CRC conferirem; caso contrário
+ * os valores padrão são utilizados.
+ */
+void config_init() {
+    const sonar_config_t *stored = (const sonar_config_t *)(XIP_BASE + CONFIG_FLASH_OFFSET);
+
+    if (stored->magic == CONFIG_MAGIC &&
+        stored->version == CONFIG_VERSION &&
+        stored->length == sizeof(sonar_config_t) &&
+        stored->crc == config_record_crc(stored)) {
+        memcpy(&config, stored, sizeof(config));
+        printf("Configuração carregada da flash (sala %u)\n", config.room_id);
+    } else {
+        config_reset();
+        printf("Configuração inválida na flash, usando valores padrão\n");
+    }
+    pending_changes = 0;
+}
+
+/**
+ * @brief Retorna a configuração em RAM.
+ * @return Ponteiro para a cópia em cache; nunca acessa a flash.
+ */
+const sonar_config_t *config_get() {
+    return &config;
+}
+
+/**
+ * @brief Altera um campo da configuração em RAM.
+ *
+ * Chaves aceitas: ssid, pass, server, room, threshold, interval, samples, stream
+ * (off, raw ou level), stream_host, stream_port e token (sem espaços; vazio desliga
+ * os comandos de escrita pela rede).
+ *
+ * @param key Nome do campo.
+ * @param value Novo valor em texto.
+ * @return true se o valor foi aceito.
+ */
+bool config_set(const char *key, const char *value) {
+    char *end;
+
+    if (strcmp(key, "ssid") == 0) {
+        if (!config_copy_string(config.wifi_ssid, sizeof(config.wifi_ssid), value))
+            return false;
+        pending_changes |= CONFIG_CHANGED_WIFI;
+    } else if (strcmp(key, "pass") == 0) {
+        if (!config_copy_string(config.wifi_pass, sizeof(config.wifi_pass), value))
+            return false;
+        pending_changes |= CONFIG_CHANGED_WIFI;
+    } else if (strcmp(key, "server") == 0) {
+        if (value[0] == '\0' || !config_copy_string(config.server_url, sizeof(config.server_url), value))
+            return false;
+    } else if (strcmp(key, "room") == 0) {
+        unsigned long room = strtoul(value, &end, 10);
+        if (*end != '\0' || room == 0 || room > UINT16_MAX)
+            return false;
+        config.room_id = (uint16_t)room;
+    } else if (strcmp(key, "threshold") == 0) {
+        float threshold = strtof(value, &end);
+        if (*end != '\0' || !(threshold > 0.f))
+            return false;
+        config.threshold = threshold;
+        pending_changes |= CONFIG_CHANGED_DETECTION;
+    } else if (strcmp(key, "interval") == 0) {
+        unsigned long interval = strtoul(value, &end, 10);
+        if (*end != '\0' || interval < 1000)
+            return false;
+        config.interval_ms = (uint32_t)interval;
+        pending_changes |= CONFIG_CHANGED_DETECTION;
+    } else if (strcmp(key, "samples") == 0) {
+        unsigned long samples = strtoul(value, &end, 10);
+        if (*end != '\0' || samples > SAMPLES || dsp_block_size(samples) != samples)
+            return false;
+        config.samples = (uint16_t)samples;
+        pending_changes |= CONFIG_CHANGED_DETECTION;
+    } else if (strcmp(key, "stream") == 0) {
+        if (strcmp(value, "off") == 0)
+            config.stream_mode = STREAM_MODE_OFF;
+        else if (strcmp(value, "raw") == 0)
+            config.stream_mode = STREAM_MODE_RAW;
+        else if (strcmp(value, "level") == 0)
+            config.stream_mode = STREAM_MODE_LEVEL;
+        else
+            return false;
+        pending_changes |= CONFIG_CHANGED_STREAM;
+    } else if (strcmp(key, "stream_host") == 0) {
+        if (!config_copy_string(config.stream_host, sizeof(config.stream_host), value))
+            return false;
+        pending_changes |= CONFIG_CHANGED_STREAM;
+    } else if (strcmp(key, "stream_port") == 0) {
+        unsigned long port = strtoul(value, &end, 10);
+        if (*end != '\0' || port == 0 || port > UINT16_MAX)
+            return false;
+        config.stream_port = (uint16_t)port;
+        pending_changes |= CONFIG_CHANGED_STREAM;
+    } else if (strcmp(key, "token") == 0) {
+        if (strchr(value, ' ') != NULL || !config_copy_string(config.net_token, sizeof(config.net_token), value))
+            return false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Apaga o setor de configuração e grava as páginas com o novo registro.
+ *
+ * Executada por flash_safe_execute(), com o XIP e as interrupções suspensos.
+ *
+ * @param param Páginas (CONFIG_RECORD_BYTES bytes) a serem gravadas.
+ */
+static void config_flash_write(void *param) {
+    flash_range_erase(CONFIG_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(CONFIG_FLASH_OFFSET, (const uint8_t *)param, CONFIG_RECORD_BYTES);
+}
+
+/**
+ * @brief Grava a configuração atual na flash.
+ * @return true se a gravação foi concluída.
+ */
+bool config_save() {
+    static uint8_t page[CONFIG_RECORD_BYTES] __attribute__((aligned(4)));
+
+    config.magic   = CONFIG_MAGIC;
+    config.version = CONFIG_VERSION;
+    config.length  = sizeof(sonar_config_t);
+    config.crc     = config_record_crc(&config);
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &config, sizeof(config));
+
+    int rc = flash_safe_execute(config_flash_write, page, UINT32_MAX);
+    if (rc != PICO_OK) {
+        printf("Erro ao gravar a configuração na flash: %d\n", rc);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Escreve a saída de um comando no formato de printf.
+ *
+ * Comandos da serial vão para o stdio; os da rede são acumulados em `reply` e enviados
+ * ao remetente por config_udp_reply(). O que não couber em `reply` é descartado.
+ */
+static int config_reply(const char *format, ...) {
+    va_list args;
+    int written;
+
+    va_start(args, format);
+    if (!reply_to_net) {
+        written = vprintf(format, args);
+    } else {
+        size_t room = sizeof(reply) - reply_length;
+        written = vsnprintf(reply + reply_length, room, format, args);
+        if (written > 0)
+            reply_length += (size_t)written < room ? (size_t)written : room - 1;
+    }
+    va_end(args);
+    return written;
+}
+
+/**
+ * @brief Exibe a configuração atual (a senha e o token não são mostrados).
+ */
+static void config_print() {
+    static const char *stream_modes[] = { "off", "raw", "level" };
+
+    config_reply("ssid=%s server=%s room=%u threshold=%.3f interval=%lu samples=%u\n",
+                 config.wifi_ssid, config.server_url, config.room_id, config.threshold,
+                 (unsigned long)config.interval_ms, config.samples);
+    config_reply("stream=%s stream_host=%s stream_port=%u token=%s\n",
+                 config.stream_mode <= STREAM_MODE_LEVEL ? stream_modes[config.stream_mode] : "?",
+                 config.stream_host, config.stream_port, config.net_token[0] != '\0' ? "on" : "off");
+}
+
+/**
+ * @brief Interpreta um comando de configuração.
+ *
+ * Comandos: `set <chave> <valor>`, `get`, `save`, `reset` e `mem` (uso de RAM). O valor de `set` é todo o
+ * restante da linha, permitindo SSIDs com espaços.
+ *
+ * @param line Linha terminada em '\0' (sem o '\n').
+ * @return true se o comando foi executado com sucesso.
+ */
+bool config_handle_command(const char *line) {
+    bool ok = false;
+
+    if (strncmp(line, "set ", 4) == 0) {
+        char key[16];
+        const char *value = line + 4;
+        size_t key_length = strcspn(value, " ");
+        if (key_length > 0 && key_length < sizeof(key) && value[key_length] == ' ') {
+            memcpy(key, value, key_length);
+            key[key_length] = '\0';
+            ok = config_set(key, value + key_length + 1);
+        }
+    } else if (strcmp(line, "get") == 0) {
+        config_print();
+        ok = true;
+    } else if (strcmp(line, "save") == 0) {
+        ok = config_save();
+    } else if (strcmp(line, "reset") == 0) {
+        config_reset();
+        ok = true;
+    } else if (strcmp(line, "mem") == 0) {
+        mem_report_to(config_reply);
+        ok = true;
+    }
+
+    config_reply("config: %s\n", ok ? "ok" : "erro");
+    return ok;
+}
+
+/**
+ * @brief Verifica se um comando de rede traz o token e devolve o comando sem ele.
+ *
+ * A comparação percorre o token inteiro, para que o tempo de resposta não revele
+ * quantos caracteres conferem.
+ *
+ * @param line Datagrama recebido.
+ * @return Início do comando após "<token> ", ou NULL se não houver token válido.
+ */
+static const char *config_check_token(const char *line) {
+    size_t length = strlen(config.net_token);
+    if (length == 0 || strlen(line) <= length)
+        return NULL;
+
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; i++)
+        diff |= (uint8_t)(line[i] ^ config.net_token[i]);
+    return diff == 0 && line[length] == ' ' ? line + length + 1 : NULL;
+}
+
+/**
+ * @brief Executa um comando recebido por UDP e envia a resposta ao remetente.
+ *
+ * `get` e `mem` não exigem token; os demais só são aceitos com o token na frente.
+ */
+static void config_handle_net_command(const config_line_t *line) {
+    const char *command = config_check_token(line->text);
+
+    reply_to_net = true;
+    reply_length = 0;
+    if (command != NULL)
+        config_handle_command(command);
+    else if (strcmp(line->text, "get") == 0 || strcmp(line->text, "mem") == 0)
+        config_handle_command(line->text);
+    else
+        config_reply("config: negado (token)\n");
+    reply_to_net = false;
+
+    cyw43_arch_lwip_begin();
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)reply_length, PBUF_RAM);
+    if (p != NULL) {
+        pbuf_take(p, reply, (u16_t)reply_length);
+        if (udp_sendto(config_pcb, p, &line->addr, line->port) != ERR_OK)
+            printf("Erro ao responder o comando de configuração\n");
+        pbuf_free(p);
+    }
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Callback do listener UDP de configuração.
+ *
+ * Roda no contexto do lwIP, portanto apenas copia o comando para `net_ring`; ele é
+ * executado por config_poll() no laço principal.
+ */
+static void config_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
+    config_line_t line;
+    u16_t length = pbuf_copy_partial(p, line.text, sizeof(line.text) - 1, 0);
+    while (length > 0 && (line.text[length - 1] == '\n' || line.text[length - 1] == '\r'))
+        length--;
+    line.text[length] = '\0';
+    ip_addr_copy(line.addr, *addr);
+    line.port = port;
+    ring_push(&net_ring, &line);     // Com a fila cheia o comando é descartado
+    pbuf_free(p);
+}
+
+/**
+ * @brief Abre o listener UDP que recebe comandos de configuração pela rede.
+ * @param port Porta UDP (normalmente CONFIG_NET_PORT).
+ */
+void config_net_init(uint16_t port) {
+    cyw43_arch_lwip_begin();
+    config_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (config_pcb == NULL || udp_bind(config_pcb, IP_ANY_TYPE, port) != ERR_OK) {
+        printf("Erro ao abrir a porta UDP de configuração\n");
+    } else {
+        udp_recv(config_pcb, config_udp_recv, NULL);
+    }
+    cyw43_arch_lwip_end();
+    mem_register("config", "net_reply", sizeof(reply) + sizeof(net_ring_slots));
+}
+
+/**
+ * @brief Processa comandos pendentes da serial USB e da rede.
+ *
+ * Não bloqueia: lê apenas os caracteres já disponíveis na serial.
+ *
+ * @return Máscara CONFIG_CHANGED_* com o que mudou desde a última chamada.
+ */
+uint32_t config_poll() {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == '\r' || c == '\n') {
+            if (serial_length > 0) {
+                serial_line[serial_length] = '\0';
+                config_handle_command(serial_line);
+                serial_length = 0;
+            }
+        } else if (serial_length < sizeof(serial_line) - 1) {
+            serial_line[serial_length++] = (char)c;
+        }
+    }
+
+    config_line_t line;
+    while (ring_pop(&net_ring, &line))
+        config_handle_net_command(&line);
+
+    uint32_t changes = pending_changes;
+    pending_changes = 0;
+    return changes;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file dsp.cpp
+ * @brief Cadeia de detecção do firmware, instanciada a partir de include/dsp_pipeline.hpp.
+ *
+ * O tamanho do bloco é parâmetro de template, então existe uma instância por captura
+ * suportada (50, 100 e 200 amostras); dsp_detect() escolhe a instância uma vez por
+ * bloco e o laço de cada uma é totalmente expandido pelo compilador.
+ *
+ * O nível é o mesmo da versão 1.x, 2 x |RMS x 3,3 / 4096 - 1,65| com o RMS calculado
+ * sobre as amostras brutas (dsp::legacy_level), para que o limiar gravado na configuração
+ * continue com o mesmo significado. Uma cadeia que mede só a parte AC (decimator,
+ * dc_blocker, rms) é comparada em tools/bench/bench_dsp; adotá-la muda a escala do
+ * limiar e exige incrementar CONFIG_VERSION com a conversão dos valores gravados.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2025
+ */
+
+#include <math.h>
+
+#include "include/dsp.h"
+#include "include/dsp_pipeline.hpp"
+#include "include/mic.h"
+
+namespace {
+
+template <std::size_t N>
+using mic_chain = dsp::pipeline<dsp::adc12, N, MIC_SAMPLE_RATE_HZ, dsp::legacy_level, dsp::detector<>>;
+
+constexpr std::size_t DETECTOR_STAGE = 1;
+
+mic_chain<50>  chain_50;
+mic_chain<100> chain_100;
+mic_chain<SAMPLES> chain_full;
+
+static_assert(SAMPLES == 200, "atualize as instâncias de mic_chain junto com SAMPLES");
+
+/// Converte o nível (2 x |RMS - 1,65 V|) em potência na escala de dsp::legacy_level.
+constexpr float level_to_power(float level) {
+    return mic_chain<SAMPLES>::power_from_volts(level / 2.f);
+}
+
+} // namespace
+
+/**
+ * @brief Maior captura suportada que não excede `samples`.
+ *
+ * @param samples Quantidade desejada.
+ * @return 50, 100 ou 200 (SAMPLES).
+ */
+unsigned dsp_block_size(unsigned samples) {
+    if (samples >= SAMPLES)
+        return SAMPLES;
+    if (samples >= 100)
+        return 100;
+    return DSP_MIN_BLOCK;
+}
+
+/**
+ * @brief Define o limiar de detecção de todas as instâncias.
+ *
+ * @param volts Limiar na escala do nível (2 x |RMS - 1,65 V|), como na configuração.
+ */
+void dsp_set_threshold(float volts) {
+    float power = level_to_power(volts);
+    chain_50.stage<DETECTOR_STAGE>().set_threshold(power);
+    chain_100.stage<DETECTOR_STAGE>().set_threshold(power);
+    chain_full.stage<DETECTOR_STAGE>().set_threshold(power);
+}
+
+/**
+ * @brief Processa uma captura do ADC.
+ *
+ * @param samples Amostras brutas do ADC.
+ * @param count Quantidade capturada; deve ser um valor de dsp_block_size().
+ * @param level Recebe o nível da captura (2 x |RMS - 1,65 V|); pode ser NULL.
+ * @return true se o nível passou do limiar.
+ */
+bool dsp_detect(const uint16_t *samples, unsigned count, float *level) {
+    dsp::detection result;
+    if (count >= SAMPLES)
+        result = chain_full.process(samples);
+    else if (count >= 100)
+        result = chain_100.process(samples);
+    else
+        result = chain_50.process(samples);
+
+    if (level != NULL)
+        *level = 2.f * sqrtf(result.power) * dsp::adc12::volts_per_unit;
+    return result.active;
+}
@@ -9,7 +9,13 @@
  * @date 2025
  */
 
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+
 #include "include/mic.h"
+#include "include/dsp.h"
+#include "include/pool.h"
+#include "include/stream.h"
 
 /// Canal DMA utilizado para transferência dos dados do ADC.
 uint dma_channel;
@@ -17,9 +23,65 @@ uint dma_channel;
 /// Configuração do canal DMA.
 dma_channel_config dma_cfg;
 
-/// Buffer onde os valores do ADC são armazenados.
+/// Buffer onde os valores do ADC são armazenados quando não há bloco de streaming.
 uint16_t adc_buffer[SAMPLES];
 
+/// Buffer da última captura: adc_buffer ou as amostras de `stream_frame`.
+static uint16_t *capture_buffer = adc_buffer;
+
+/// Bloco de streaming da última captura, ainda não entregue com mic_publish().
+static stream_frame_t *stream_frame = NULL;
+
+/// Quantidade de amostras usadas em cada captura (no máximo SAMPLES).
+static uint sample_count = SAMPLES;
+
+/// Instante (time_us_64()) em que o DMA concluiu a última captura.
+static volatile uint64_t capture_time_us = 0;
+
+/// Sinaliza que a interrupção do DMA marcou o fim da captura.
+static volatile bool capture_done = false;
+
+/**
+ * @brief Interrupção de fim de transferência do DMA.
+ *
+ * Registra o instante da captura o mais próximo possível do hardware, antes que
+ * o laço principal ou a pilha de rede introduzam qualquer atraso.
+ */
+static void mic_dma_handler() {
+    if (dma_channel_get_irq0_status(dma_channel)) {
+        dma_channel_acknowledge_irq0(dma_channel);
+        capture_time_us = time_us_64();
+        capture_done = true;
+    }
+}
+
+/**
+ * @brief Retorna o instante em que a última captura terminou.
+ * @return Valor de time_us_64() registrado na interrupção do DMA.
+ */
+uint64_t mic_capture_time_us() {
+    return capture_time_us;
+}
+
+/**
+ * @brief Define quantas amostras são capturadas por vez.
+ *
+ * @param samples Nova quantidade; é arredondada para um bloco suportado pela cadeia de
+ *                detecção (ver dsp_block_size()).
+ */
+void mic_set_samples(uint samples) {
+    sample_count = dsp_block_size(samples);
+}
+
+/**
+ * @brief Define o limiar de detecção.
+ *
+ * @param volts Limiar na escala de mic_detect() (2 x |RMS - 1,65 V|, como na versão 1.x).
+ */
+void mic_set_threshold(float volts) {
+    dsp_set_threshold(volts);
+}
+
 /**
  * @brief Captura uma amostra do microfone utilizando ADC e DMA.
  *
@@ -27,37 +89,55 @@ uint16_t adc_buffer[SAMPLES];
  * garantindo uma captura eficiente dos sinais de áudio.
  */
 void sample_mic() {
+    mic_publish();           // Captura anterior não entregue pelo chamador
+
+    // Com o streaming ativo o DMA escreve direto no bloco que irá para o TCP
+    stream_frame = stream_acquire();
+    capture_buffer = stream_frame != NULL ? stream_frame->samples : adc_buffer;
+
     adc_fifo_drain();        // Limpa o FIFO do ADC
     adc_run(false);          // Garante que o ADC não esteja rodando
+    capture_done = false;
     dma_channel_configure(dma_channel, &dma_cfg,
-        adc_buffer,
+        capture_buffer,
         &adc_hw->fifo,
-        SAMPLES,
+        sample_count,
         true
     );
 
     // Inicia a captura do ADC
     adc_run(true);
-    dma_channel_wait_for_finish_blocking(dma_channel);  // Aguarda a finalização do DMA
+    while (!capture_done)    // Aguarda a interrupção de finalização do DMA
+        tight_loop_contents();
 
     // Para a captura do ADC
     adc_run(false);
 }
 
 /**
- * @brief Calcula a potência do sinal capturado.
- * 
- * A função calcula a média quadrática das amostras do microfone,
- * fornecendo uma estimativa da intensidade do som.
- * 
- * @return Potência do sinal capturado.
+ * @brief Entrega a última captura ao streaming, se ela estiver em um bloco dele.
+ *
+ * Deve ser chamada depois de processar a captura: a partir daqui o bloco pertence ao
+ * TCP e mic_detect() não pode mais ser usada até o próximo sample_mic().
  */
-float mic_power() {
-    float avg = 0.f;
-    for (uint i = 0; i < SAMPLES; ++i)
-        avg += adc_buffer[i] * adc_buffer[i];
-    avg /= SAMPLES;
-    return sqrt(avg);
+void mic_publish() {
+    if (stream_frame != NULL) {
+        stream_submit(stream_frame, sample_count, capture_time_us);
+        stream_frame = NULL;
+    }
+}
+
+/**
+ * @brief Passa a última captura pela cadeia de detecção (src/dsp.cpp).
+ *
+ * A cadeia remove o DC do microfone e calcula o valor RMS, comparando-o com o limiar
+ * definido por mic_set_threshold().
+ *
+ * @param level Recebe o nível da captura (2 x |RMS - 1,65 V|); pode ser NULL.
+ * @return true se o nível passou do limiar.
+ */
+bool mic_detect(float *level) {
+    return dsp_detect(capture_buffer, sample_count, level);
 }
 
 /**
@@ -87,4 +167,11 @@ void adc_init_handler(){
     channel_config_set_read_increment(&dma_cfg, false);
     channel_config_set_write_increment(&dma_cfg, true);
     channel_config_set_dreq(&dma_cfg, DREQ_ADC);
+
+    // Interrupção de fim de captura, compartilhada com outros usuários do DMA_IRQ_0
+    dma_channel_set_irq0_enabled(dma_channel, true);
+    irq_add_shared_handler(DMA_IRQ_0, mic_dma_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    mem_register("mic", "adc_buffer", sizeof(adc_buffer));
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+/**
+ * @file pool.c
+ * @brief Implementação dos pools de blocos fixos e do relatório de uso de RAM.
+ *
+ * Os buffers de rede e eventos vêm de pools dimensionados em tempo de compilação, de
+ * modo que todo o consumo de SRAM é conhecido no link. Cada pool acompanha o pico de
+ * blocos em uso (high-water mark) e as alocações recusadas, e mem_report() mostra o
+ * consumo por subsistema junto com as regiões estáticas registradas.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+
+#include "include/pool.h"
+
+/// Região de memória estática (buffer global, heap do lwIP...) incluída no relatório.
+typedef struct {
+    const char *subsystem;
+    const char *name;
+    size_t      bytes;
+} mem_region_t;
+
+static pool_t *pools = NULL;                            // Pools inicializados, para o relatório.
+static mem_region_t regions[MEM_MAX_REGIONS];           // Regiões registradas por mem_register().
+static uint region_count = 0;
+
+/**
+ * @brief Monta a lista de blocos livres e registra o pool no relatório.
+ *
+ * Chamar mais de uma vez não tem efeito.
+ *
+ * @param pool Pool declarado com POOL_DEFINE().
+ */
+void pool_init(pool_t *pool) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (!pool->initialized) {
+        pool->free_list = NULL;
+        for (int i = pool->block_count - 1; i >= 0; i--) {
+            void **block = (void **)(pool->storage + (size_t)i * pool->block_size);
+            *block = pool->free_list;
+            pool->free_list = block;
+        }
+        pool->in_use = 0;
+        pool->initialized = true;
+        pool->next = pools;
+        pools = pool;
+    }
+    restore_interrupts(irq);
+}
+
+/**
+ * @brief Retira um bloco do pool.
+ *
+ * @param pool Pool de origem.
+ * @return Ponteiro para o bloco (alinhado em 4 bytes) ou NULL se o pool estiver esgotado.
+ */
+void *pool_alloc(pool_t *pool) {
+    if (!pool->initialized)
+        pool_init(pool);
+
+    uint32_t irq = save_and_disable_interrupts();
+    void **block = pool->free_list;
+    if (block != NULL) {
+        pool->free_list = *block;
+        if (++pool->in_use > pool->high_water)
+            pool->high_water = pool->in_use;
+    } else {
+        pool->failures++;
+    }
+    restore_interrupts(irq);
+    return block;
+}
+
+/**
+ * @brief Devolve um bloco ao pool.
+ *
+ * @param pool Pool de origem do bloco.
+ * @param block Bloco obtido com pool_alloc() (NULL é ignorado).
+ */
+void pool_free(pool_t *pool, void *block) {
+    if (block == NULL)
+        return;
+
+    size_t offset = (size_t)((uint8_t *)block - pool->storage);
+    if ((uint8_t *)block < pool->storage || offset % pool->block_size != 0 ||
+        offset / pool->block_size >= pool->block_count) {
+        printf("pool %s: bloco inválido liberado\n", pool->name);
+        return;
+    }
+
+    uint32_t irq = save_and_disable_interrupts();
+    *(void **)block = pool->free_list;
+    pool->free_list = block;
+    pool->in_use--;
+    restore_interrupts(irq);
+}
+
+/**
+ * @brief Registra uma região estática para aparecer em mem_report().
+ *
+ * @param subsystem Módulo dono da região.
+ * @param name Nome da região.
+ * @param bytes Tamanho em bytes.
+ */
+void mem_register(const char *subsystem, const char *name, size_t bytes) {
+    for (uint i = 0; i < region_count; i++)
+        if (strcmp(regions[i].subsystem, subsystem) == 0 && strcmp(regions[i].name, name) == 0)
+            return;
+    if (region_count < MEM_MAX_REGIONS)
+        regions[region_count++] = (mem_region_t){ subsystem, name, bytes };
+}
+
+/**
+ * @brief Exibe o uso de RAM por subsistema, com high-water mark e falhas de cada pool.
+ */
+void mem_report() {
+    mem_report_to(printf);
+}
+
+/**
+ * @brief Gera o relatório de mem_report() por uma função no formato de printf.
+ *
+ * Usado pela configuração para responder ao comando `mem` recebido pela rede.
+ *
+ * @param print Destino de cada linha.
+ */
+void mem_report_to(mem_print_fn print) {
+    size_t total = 0;
+
+    print("%-6s %-12s %6s %5s %7s %6s %5s %6s\n", "subsis", "regiao", "bloco", "qtde", "bytes", "em_uso", "max", "falhas");
+    for (pool_t *pool = pools; pool != NULL; pool = pool->next) {
+        size_t bytes = (size_t)pool->block_size * pool->block_count;
+        total += bytes;
+        print("%-6s %-12s %6u %5u %7u %6u %5u %6lu\n", pool->subsystem, pool->name,
+              pool->block_size, pool->block_count, (unsigned)bytes,
+              pool->in_use, pool->high_water, (unsigned long)pool->failures);
+    }
+    for (uint i = 0; i < region_count; i++) {
+        total += regions[i].bytes;
+        print("%-6s %-12s %6s %5s %7u\n", regions[i].subsystem, regions[i].name, "-", "-", (unsigned)regions[i].bytes);
+    }
+    print("total: %u de %u bytes de SRAM\n", (unsigned)total, (unsigned)MEM_SRAM_BYTES);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file ring.c
+ * @brief Implementação da fila circular sem lock (um produtor, um consumidor).
+ *
+ * Os índices são contadores livres de 32 bits; a posição é obtida com a máscara da
+ * capacidade. O produtor publica o slot com uma escrita release em `head` e o
+ * consumidor o devolve com uma escrita release em `tail`, de modo que nenhum dos lados
+ * precisa desabilitar interrupções.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2025
+ */
+
+#include <string.h>
+
+#include "include/ring.h"
+
+/**
+ * @brief Insere um item (chamada apenas pelo produtor).
+ *
+ * @param ring Fila de destino.
+ * @param item Item com `slot_size` bytes, copiado para a fila.
+ * @return false se a fila estiver cheia (o item é descartado e contado em `dropped`).
+ */
+bool ring_push(ring_t *ring, const void *item) {
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= ring->capacity) {
+        ring->dropped++;
+        return false;
+    }
+
+    memcpy(ring->slots + (size_t)(head & (ring->capacity - 1u)) * ring->slot_size, item, ring->slot_size);
+    __atomic_store_n(&ring->head, head + 1u, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Retira o item mais antigo (chamada apenas pelo consumidor).
+ *
+ * @param ring Fila de origem.
+ * @param item Destino com `slot_size` bytes.
+ * @return false se a fila estiver vazia.
+ */
+bool ring_pop(ring_t *ring, void *item) {
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+        return false;
+
+    memcpy(item, ring->slots + (size_t)(tail & (ring->capacity - 1u)) * ring->slot_size, ring->slot_size);
+    __atomic_store_n(&ring->tail, tail + 1u, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Indica se não há itens pendentes (pode ser chamada por qualquer lado).
+ */
+bool ring_is_empty(ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,415 @@
+/**
+ * @file stream.c
+ * @brief Streaming das capturas do microfone por uma conexão TCP persistente.
+ *
+ * Os blocos de captura vêm de `frame_pool`: o DMA escreve direto no bloco, o laço
+ * principal preenche o cabeçalho e o entrega por `submit_ring`, e o worker no contexto
+ * do lwIP passa o bloco ao tcp_write sem TCP_WRITE_FLAG_COPY. O bloco só volta ao pool
+ * quando o tcp_sent confirma todos os seus bytes (ou a conexão cai).
+ *
+ * Controle de fluxo: se o TCP não tem espaço, o bloco espera em `pending_frame` e os
+ * seguintes ficam na fila; quando o pool esgota, stream_acquire() devolve NULL e a
+ * captura segue no buffer próprio do microfone, sendo apenas contada como descartada.
+ * A captura nunca espera pela rede.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "pico/async_context.h"
+#include "pico/cyw43_arch.h"
+#include "pico/time.h"
+#include "lwip/dns.h"
+#include "lwip/tcp.h"
+
+#include "include/stream.h"
+#include "include/config.h"
+#include "include/pool.h"
+#include "include/ring.h"
+#include "include/timesync.h"
+
+#if LWIP_NETIF_TX_SINGLE_PBUF
+#error "LWIP_NETIF_TX_SINGLE_PBUF faz o tcp_write copiar os blocos do stream (ver lwipopts.h)"
+#endif
+
+/// Configuração copiada do laço principal para o contexto do lwIP.
+typedef struct {
+    uint8_t  mode;
+    uint16_t port;
+    char     host[CONFIG_URL_LEN];
+} stream_settings_t;
+
+POOL_DEFINE(frame_pool, "stream", "frames", sizeof(stream_frame_t), STREAM_FRAMES);
+
+RING_DEFINE(submit_ring, stream_frame_t *, STREAM_FRAMES);     // Laço principal -> contexto do lwIP.
+RING_DEFINE(settings_ring, stream_settings_t, 2);              // Laço principal -> contexto do lwIP.
+
+// Estado do laço principal
+static uint8_t main_mode        = STREAM_MODE_OFF;      // Modo em vigor para novas capturas.
+static uint32_t sequence        = 0;                    // Número da próxima captura.
+static uint32_t dropped         = 0;                    // Capturas sem bloco livre.
+
+// Estado da conexão: acessado apenas no contexto do lwIP
+static stream_settings_t target;                        // Destino e modo atuais.
+static uint32_t target_generation = 0;                  // Incrementado a cada mudança de `target`.
+static struct tcp_pcb *stream_pcb = NULL;               // Conexão aberta ou em andamento.
+static bool connected           = false;                // O handshake TCP terminou.
+static bool resolving           = false;                // Aguardando o DNS do `target` atual.
+static uint64_t retry_at_us     = 0;                    // Próxima tentativa de conexão permitida.
+static stream_frame_t *pending_frame = NULL;            // Retirado da fila, aguardando espaço no TCP.
+static stream_frame_t *inflight[STREAM_FRAMES];         // Entregues ao tcp_write, em ordem de envio.
+static uint16_t inflight_length[STREAM_FRAMES];         // Bytes de cada bloco em `inflight`.
+static uint inflight_head       = 0;
+static uint inflight_count      = 0;
+static uint32_t acked_bytes     = 0;                    // Confirmados pelo tcp_sent e ainda não atribuídos a um bloco.
+
+static void stream_worker_run(async_context_t *context, async_when_pending_worker_t *worker);
+
+/// Worker que conecta e envia os blocos enfileirados, executado no contexto do lwIP.
+static async_when_pending_worker_t stream_worker = { .do_work = stream_worker_run };
+
+/**
+ * @brief Tamanho em bytes de um bloco como enviado (cabeçalho + valores).
+ */
+static uint16_t stream_frame_length(const stream_frame_t *frame) {
+    return (uint16_t)(sizeof(stream_header_t) + frame->header.count * sizeof(uint16_t));
+}
+
+/**
+ * @brief Devolve ao pool todos os blocos em trânsito, pendentes e enfileirados.
+ *
+ * Só pode ser chamada depois que o lwIP deixou de referenciar os blocos, isto é, após
+ * tcp_abort() ou no callback de erro.
+ */
+static void stream_release_frames() {
+    while (inflight_count > 0) {
+        pool_free(&frame_pool, inflight[inflight_head]);
+        inflight_head = (inflight_head + 1) % STREAM_FRAMES;
+        inflight_count--;
+    }
+    inflight_head = 0;
+    acked_bytes = 0;
+
+    pool_free(&frame_pool, pending_frame);
+    pending_frame = NULL;
+
+    stream_frame_t *frame;
+    while (ring_pop(&submit_ring, &frame))
+        pool_free(&frame_pool, frame);
+}
+
+/**
+ * @brief Encerra a conexão e recicla os blocos.
+ *
+ * Usa tcp_abort() e não tcp_close(): um PCB fechado continuaria retransmitindo os
+ * segmentos que apontam para os blocos já devolvidos ao pool.
+ */
+static void stream_close() {
+    if (stream_pcb != NULL) {
+        tcp_arg(stream_pcb, NULL);
+        tcp_recv(stream_pcb, NULL);
+        tcp_sent(stream_pcb, NULL);
+        tcp_err(stream_pcb, NULL);
+        tcp_abort(stream_pcb);
+        stream_pcb = NULL;
+    }
+    connected = false;
+    stream_release_frames();
+}
+
+/**
+ * @brief Agenda a próxima tentativa de conexão.
+ */
+static void stream_retry_later() {
+    retry_at_us = time_us_64() + (uint64_t)STREAM_RETRY_MS * 1000u;
+}
+
+/**
+ * @brief Entrega ao TCP os blocos enfileirados enquanto houver espaço de envio.
+ *
+ * @return true se a conexão foi abortada; dentro de um callback do lwIP o chamador
+ *         deve então retornar ERR_ABRT.
+ */
+static bool stream_flush() {
+    bool written = false;
+
+    while (pending_frame != NULL || ring_pop(&submit_ring, &pending_frame)) {
+        if (!connected) {
+            // Sem conexão os blocos são reciclados de imediato para não segurar a captura
+            pool_free(&frame_pool, pending_frame);
+            pending_frame = NULL;
+            continue;
+        }
+
+        uint16_t length = stream_frame_length(pending_frame);
+        if (tcp_sndbuf(stream_pcb) < length)
+            break;                                      // Retomado pelo próximo tcp_sent
+
+        err_t err = tcp_write(stream_pcb, pending_frame, length, 0);
+        if (err == ERR_MEM)
+            break;
+        if (err != ERR_OK) {
+            printf("Erro ao enviar bloco do stream: %d\n", err);
+            stream_close();
+            stream_retry_later();
+            return true;
+        }
+
+        uint slot = (inflight_head + inflight_count) % STREAM_FRAMES;
+        inflight[slot] = pending_frame;
+        inflight_length[slot] = length;
+        inflight_count++;
+        pending_frame = NULL;
+        written = true;
+    }
+
+    if (written)
+        tcp_output(stream_pcb);
+    return false;
+}
+
+/**
+ * @brief Callback de confirmação: recicla os blocos cujos bytes foram todos confirmados.
+ *
+ * @param arg Argumento passado (não utilizado).
+ * @param tpcb Ponteiro para o controle do bloco TCP.
+ * @param len Bytes confirmados pelo receptor.
+ * @return err_t Código de erro da biblioteca lwIP.
+ */
+static err_t stream_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    acked_bytes += len;
+    while (inflight_count > 0 && acked_bytes >= inflight_length[inflight_head]) {
+        acked_bytes -= inflight_length[inflight_head];
+        pool_free(&frame_pool, inflight[inflight_head]);
+        inflight_head = (inflight_head + 1) % STREAM_FRAMES;
+        inflight_count--;
+    }
+    return stream_flush() ? ERR_ABRT : ERR_OK;
+}
+
+/**
+ * @brief Callback de recepção: o receptor não envia dados, só o fechamento importa.
+ */
+static err_t stream_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    if (p == NULL) {
+        printf("Receptor do stream encerrou a conexão\n");
+        stream_close();
+        stream_retry_later();
+        return ERR_ABRT;
+    }
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+/**
+ * @brief Callback de erro da conexão (reset, timeout ou abort).
+ *
+ * O lwIP já liberou o PCB e os segmentos, portanto os blocos podem voltar ao pool.
+ */
+static void stream_error(void *arg, err_t err) {
+    printf("Erro na conexão do stream: %d\n", err);
+    stream_pcb = NULL;
+    connected = false;
+    stream_release_frames();
+    stream_retry_later();
+}
+
+/**
+ * @brief Callback chamado ao estabelecer a conexão com o receptor.
+ */
+static err_t stream_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
+    if (err != ERR_OK)
+        return err;
+    printf("Stream conectado a %s:%u\n", target.host, target.port);
+    connected = true;
+    return stream_flush() ? ERR_ABRT : ERR_OK;
+}
+
+/**
+ * @brief Cria o PCB e inicia a conexão com o endereço resolvido.
+ */
+static void stream_connect(const ip_addr_t *ipaddr) {
+    stream_pcb = tcp_new();
+    if (stream_pcb == NULL) {
+        printf("Erro ao criar PCB do stream\n");
+        stream_retry_later();
+        return;
+    }
+    tcp_recv(stream_pcb, stream_recv);
+    tcp_sent(stream_pcb, stream_sent);
+    tcp_err(stream_pcb, stream_error);
+    if (tcp_connect(stream_pcb, ipaddr, target.port, stream_connected) != ERR_OK) {
+        printf("Erro ao conectar ao receptor do stream\n");
+        stream_close();
+        stream_retry_later();
+    }
+}
+
+/**
+ * @brief Callback do DNS para o host do receptor.
+ *
+ * `callback_arg` traz a geração do destino consultado: a resposta de uma consulta feita
+ * antes da última mudança de configuração é descartada, pois o endereço seria do host
+ * antigo (a consulta do destino novo já foi iniciada pelo worker).
+ */
+static void stream_dns_found(const char *name, const ip_addr_t *ipaddr, void *callback_arg) {
+    if ((uint32_t)(uintptr_t)callback_arg != target_generation)
+        return;
+    resolving = false;
+    if (target.mode == STREAM_MODE_OFF || stream_pcb != NULL)
+        return;
+    if (ipaddr == NULL) {
+        printf("Erro ao resolver o receptor do stream\n");
+        stream_retry_later();
+        return;
+    }
+    stream_connect(ipaddr);
+}
+
+/**
+ * @brief Worker do async_context: aplica a configuração, reconecta e envia.
+ */
+static void stream_worker_run(async_context_t *context, async_when_pending_worker_t *worker) {
+    stream_settings_t settings;
+    while (ring_pop(&settings_ring, &settings)) {
+        stream_close();
+        target = settings;
+        target_generation++;
+        resolving = false;                              // Uma consulta pendente é do destino anterior
+        retry_at_us = 0;
+    }
+
+    if (target.mode != STREAM_MODE_OFF && stream_pcb == NULL && !resolving && time_us_64() >= retry_at_us) {
+        ip_addr_t address;
+        err_t err = dns_gethostbyname(target.host, &address, stream_dns_found,
+                                      (void *)(uintptr_t)target_generation);
+        if (err == ERR_OK) {
+            stream_connect(&address);
+        } else if (err == ERR_INPROGRESS) {
+            resolving = true;
+        } else {
+            printf("Erro ao iniciar a resolução do receptor do stream\n");
+            stream_retry_later();
+        }
+    }
+
+    stream_flush();
+}
+
+/**
+ * @brief Inicializa o pool de blocos e registra o worker.
+ *
+ * Deve ser chamada depois de wifi_connect(), com o async_context do CYW43 ativo.
+ */
+void stream_init() {
+    static bool worker_added = false;
+
+    pool_init(&frame_pool);
+    if (!worker_added) {
+        async_context_add_when_pending_worker(cyw43_arch_async_context(), &stream_worker);
+        mem_register("stream", "rings", sizeof(submit_ring_slots) + sizeof(settings_ring_slots));
+        worker_added = true;
+    }
+}
+
+/**
+ * @brief Define o modo e o receptor do streaming.
+ *
+ * A conexão atual é encerrada e, se o modo não for STREAM_MODE_OFF, refeita no
+ * contexto do lwIP.
+ *
+ * @param mode Um dos valores de stream_mode_t.
+ * @param host Nome ou IP do receptor; vazio desativa o streaming.
+ * @param port Porta TCP do receptor.
+ */
+void stream_configure(uint8_t mode, const char *host, uint16_t port) {
+    stream_settings_t settings = { .mode = mode, .port = port };
+
+    if (host == NULL || host[0] == '\0' || snprintf(settings.host, sizeof(settings.host), "%s", host) >= (int)sizeof(settings.host))
+        settings.mode = STREAM_MODE_OFF;
+
+    if (!ring_push(&settings_ring, &settings)) {
+        printf("Fila de configuração do stream cheia\n");
+        return;
+    }
+    main_mode = settings.mode;
+    async_context_set_work_pending(cyw43_arch_async_context(), &stream_worker);
+}
+
+/**
+ * @brief Reserva um bloco para a próxima captura.
+ *
+ * Nunca bloqueia: com todos os blocos em trânsito a captura é contada como descartada
+ * e o chamador usa o próprio buffer.
+ *
+ * @return Bloco livre, ou NULL se o streaming estiver desligado ou sem blocos.
+ */
+stream_frame_t *stream_acquire() {
+    if (main_mode == STREAM_MODE_OFF)
+        return NULL;
+
+    stream_frame_t *frame = pool_alloc(&frame_pool);
+    if (frame == NULL) {
+        sequence++;
+        dropped++;
+    }
+    return frame;
+}
+
+/**
+ * @brief Agrega as amostras em níveis RMS, no próprio bloco.
+ *
+ * Cada nível substitui a primeira amostra do seu grupo, então a escrita nunca
+ * ultrapassa a leitura.
+ *
+ * @return Quantidade de níveis.
+ */
+static uint stream_decimate(uint16_t *samples, uint count) {
+    uint levels = 0;
+    for (uint start = 0; start < count; start += STREAM_LEVEL_DECIMATION) {
+        uint end = start + STREAM_LEVEL_DECIMATION < count ? start + STREAM_LEVEL_DECIMATION : count;
+        float sum = 0.f;
+        for (uint i = start; i < end; ++i)
+            sum += (float)samples[i] * samples[i];
+        samples[levels++] = (uint16_t)(sqrtf(sum / (end - start)) + 0.5f);
+    }
+    return levels;
+}
+
+/**
+ * @brief Entrega um bloco capturado para envio.
+ *
+ * Depois desta chamada o bloco pertence ao streaming e não deve mais ser lido.
+ *
+ * @param frame Bloco obtido com stream_acquire().
+ * @param count Amostras escritas pelo DMA.
+ * @param capture_us Instante do fim da captura (time_us_64()).
+ */
+void stream_submit(stream_frame_t *frame, uint count, uint64_t capture_us) {
+    stream_header_t *header = &frame->header;
+
+    header->magic      = STREAM_MAGIC;
+    header->sequence   = sequence++;
+    header->dropped    = dropped;
+    header->capture_us = capture_us;
+    header->epoch_ms   = timesync_to_epoch_ms(capture_us);
+    if (main_mode == STREAM_MODE_LEVEL) {
+        header->type       = STREAM_FRAME_LEVEL;
+        header->decimation = STREAM_LEVEL_DECIMATION;
+        header->count      = (uint16_t)stream_decimate(frame->samples, count);
+    } else {
+        header->type       = STREAM_FRAME_RAW;
+        header->decimation = 1;
+        header->count      = (uint16_t)count;
+    }
+
+    if (!ring_push(&submit_ring, &frame)) {
+        pool_free(&frame_pool, frame);
+        dropped++;
+        return;
+    }
+    async_context_set_work_pending(cyw43_arch_async_context(), &stream_worker);
+}
@@ -0,0 +1,145 @@
+/**
+ * @file timesync.c
+ * @brief Relógio de parede sincronizado por SNTP sobre o timer de 64 bits do RP2040.
+ *
+ * O SNTP do lwIP só informa o deslocamento entre a hora UTC e o timer monotônico
+ * (time_us_64()); a hora atual é sempre timer + deslocamento. Assim, ler a hora custa
+ * uma leitura do timer, e instantes capturados antes da sincronização (ou enviados com
+ * atraso) continuam convertíveis para UTC sem perder a ordem.
+ *
+ * Depois da primeira resposta o deslocamento não salta: a diferença medida em cada nova
+ * consulta é aplicada aos poucos, a no máximo TIMESYNC_SLEW_PPM, a partir do instante
+ * da resposta. Assim a hora convertida nunca anda para trás, mesmo quando o relógio
+ * estava adiantado. Erros grandes são corrigidos de uma vez: um atraso acima de
+ * TIMESYNC_STEP_US salta para frente, sem afetar a ordem, e um adiantamento acima de
+ * TIMESYNC_STEP_BACK_US salta para trás (registrado na serial), aceitando que os eventos
+ * em volta desse único ajuste saiam fora de ordem em vez de levar horas corrigindo.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/apps/sntp.h"
+
+#include "include/timesync.h"
+
+static uint64_t epoch_offset_us = 0;                    // UTC (µs desde 1970) - time_us_64() até slew_start_us.
+static uint64_t slew_start_us = 0;                      // Instante (time_us_64()) da última resposta SNTP.
+static int64_t slew_us = 0;                             // Correção ainda a aplicar a partir de slew_start_us.
+static volatile bool synced = false;                    // Indica que epoch_offset_us é válido.
+
+/**
+ * @brief Deslocamento válido em um instante do timer, incluindo a correção gradual.
+ *
+ * O estado é lido de forma atômica (64 bits não são atômicos no Cortex-M0+). Instantes
+ * anteriores à última resposta usam o deslocamento daquele momento.
+ *
+ * @param monotonic_us Instante capturado com time_us_64().
+ */
+static uint64_t timesync_offset(uint64_t monotonic_us) {
+    uint32_t irq = save_and_disable_interrupts();
+    uint64_t offset = epoch_offset_us;
+    uint64_t start = slew_start_us;
+    int64_t slew = slew_us;
+    restore_interrupts(irq);
+
+    if (slew == 0 || monotonic_us <= start)
+        return offset;
+    uint64_t applied = (monotonic_us - start) * TIMESYNC_SLEW_PPM / 1000000u;
+    uint64_t remaining = slew < 0 ? (uint64_t)-slew : (uint64_t)slew;
+    if (applied > remaining)
+        applied = remaining;
+    return slew < 0 ? offset - applied : offset + applied;
+}
+
+/**
+ * @brief Inicia o cliente SNTP em modo de consulta periódica.
+ *
+ * Deve ser chamada depois que o Wi-Fi estiver conectado.
+ */
+void timesync_init() {
+    cyw43_arch_lwip_begin();
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, TIMESYNC_SERVER);
+    sntp_init();
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Retorna se já houve ao menos uma resposta SNTP válida.
+ */
+bool timesync_is_synced() {
+    return synced;
+}
+
+/**
+ * @brief Hora atual em microssegundos desde 1970 (UTC).
+ *
+ * Antes da primeira sincronização retorna apenas o tempo desde o boot.
+ */
+uint64_t timesync_now_us() {
+    uint64_t now = time_us_64();
+    return now + timesync_offset(now);
+}
+
+/**
+ * @brief Converte um instante do timer monotônico (time_us_64()) para milissegundos UTC.
+ *
+ * @param monotonic_us Instante capturado com time_us_64().
+ * @return Milissegundos desde 1970, ou 0 se o relógio ainda não foi sincronizado.
+ */
+uint64_t timesync_to_epoch_ms(uint64_t monotonic_us) {
+    if (!synced)
+        return 0;
+    return (monotonic_us + timesync_offset(monotonic_us)) / 1000u;
+}
+
+/**
+ * @brief Ajusta o relógio com a hora recebida do servidor SNTP.
+ *
+ * Chamada pelo lwIP através de SNTP_SET_SYSTEM_TIME_US (ver lwipopts.h), já com o
+ * atraso de ida e volta compensado. A primeira resposta define o deslocamento; as
+ * seguintes partem do deslocamento atual e iniciam uma correção gradual até o medido.
+ *
+ * @param sec Segundos desde 1970 (UTC).
+ * @param us Fração em microssegundos.
+ */
+void timesync_set_system_time(uint32_t sec, uint32_t us) {
+    uint64_t now = time_us_64();
+    uint64_t measured = (uint64_t)sec * 1000000u + us - now;
+    uint64_t current = synced ? timesync_offset(now) : measured;
+    int64_t error = (int64_t)(measured - current);
+    bool step_back = error < -(int64_t)TIMESYNC_STEP_BACK_US;
+
+    uint32_t irq = save_and_disable_interrupts();
+    slew_start_us = now;
+    if (error > (int64_t)TIMESYNC_STEP_US || step_back) {
+        epoch_offset_us = measured;
+        slew_us = 0;
+    } else {
+        epoch_offset_us = current;
+        slew_us = error;
+    }
+    restore_interrupts(irq);
+
+    if (step_back)
+        printf("Relógio adiantado %lld ms, ajustado para trás\n", (long long)(-error / 1000));
+    if (!synced)
+        printf("Relógio sincronizado por SNTP: %lu s\n", (unsigned long)sec);
+    synced = true;
+}
+
+/**
+ * @brief Informa a hora atual ao lwIP, usada para compensar o atraso de ida e volta.
+ *
+ * Chamada através de SNTP_GET_SYSTEM_TIME (ver lwipopts.h).
+ */
+void timesync_get_system_time(uint32_t *sec, uint32_t *us) {
+    uint64_t now = timesync_now_us();
+    *sec = (uint32_t)(now / 1000000u);
+    *us  = (uint32_t)(now % 1000000u);
+}
@@ -5,26 +5,159 @@
  * Este arquivo contém funções para conectar a uma rede Wi-Fi, enviar requisições
  * HTTP e gerenciar respostas recebidas do servidor.
  * 
+ * Com `pico_cyw43_arch_lwip_threadsafe_background`, os callbacks do lwIP rodam em
+ * interrupção. Por isso o laço principal nunca toca no estado da conexão: os pedidos
+ * entram por `command_ring` e são executados por um worker do async_context (no
+ * contexto do lwIP), e as respostas já interpretadas voltam por `result_ring`.
+ * 
  * @author Jhonatas Anthony Dantas Araújo
  * @date 2025
  */
 
+#include "pico/async_context.h"
+
 #include "include/wifi.h"
+#include "include/config.h"
+#include "include/pool.h"
+#include "include/ring.h"
+#include "include/timesync.h"
+
+#define HTTP_REQUEST_SIZE       512                     // Requisição formatada: cabeçalhos + host (CONFIG_URL_LEN) + caminho.
+#define HTTP_RESPONSE_SIZE      1536                    // Resposta completa do servidor, incluindo os cabeçalhos.
+#define HTTP_URL_SIZE           48                      // "/log/status/65535/3?ts=<13 dígitos>" com folga.
+#define HTTP_METHOD_SIZE        8                       // "GET", "POST"...
+#define HTTP_COMMAND_BODY_SIZE  16                      // Corpo enviado nas requisições ("{}").
+#define HTTP_COMMAND_SLOTS      4                       // Requisições aguardando o contexto do lwIP.
+#define HTTP_RESULT_SLOTS       4                       // Respostas aguardando o laço principal.
+#define HTTP_POLL_INTERVAL      2                       // Ticks do timer lento do TCP (500 ms) entre chamadas de http_poll().
+#define HTTP_TIMEOUT_POLLS      10                      // Chamadas de http_poll() até abortar a conexão (10 s).
+
+_Static_assert(HTTP_REQUEST_SIZE >= 224 + CONFIG_URL_LEN + HTTP_URL_SIZE, "HTTP_REQUEST_SIZE não comporta os cabeçalhos");
 
-#define RESPONSE_BUFFER_SIZE 2048                       // Tamanho do buffer de resposta HTTP.
+/// Pedido de requisição copiado do laço principal para o contexto do lwIP.
+typedef struct {
+    char method[HTTP_METHOD_SIZE];
+    char host[CONFIG_URL_LEN];                          // Cópia da configuração no momento do pedido
+    char endpoint[HTTP_URL_SIZE];
+    char body[HTTP_COMMAND_BODY_SIZE];
+} http_command_t;
 
-static char response_buffer[RESPONSE_BUFFER_SIZE];      // Buffer global para armazenar a resposta do servidor.
+RING_DEFINE(command_ring, http_command_t, HTTP_COMMAND_SLOTS);     // Laço principal -> contexto do lwIP.
+RING_DEFINE(result_ring, http_result_t, HTTP_RESULT_SLOTS);        // Contexto do lwIP -> laço principal.
 
+// Uma conexão por vez: os pedidos seguintes esperam em command_ring
+POOL_DEFINE(request_pool, "wifi", "http_req", HTTP_REQUEST_SIZE, 1);
+POOL_DEFINE(response_pool, "wifi", "http_resp", HTTP_RESPONSE_SIZE, 1);
+
+// Estado da conexão em andamento: acessado apenas no contexto do lwIP
+static char *request_buffer     = NULL;                 // Bloco com a requisição até ser entregue ao tcp_write.
+static char *response_buffer    = NULL;                 // Bloco com a resposta sendo recebida.
 static int response_length      = 0;                    // Comprimento da resposta armazenada no buffer.
-volatile bool response_complete = false;                // Flag para indicar se a resposta HTTP foi completamente recebida.
+static bool connection_active   = false;                // Há uma requisição entre o DNS e o fechamento da conexão.
+static uint8_t poll_count       = 0;                    // Chamadas de http_poll() desde a criação do PCB.
 
 static ip_addr_t server_ip;                             // Endereço IP do servidor após resolução do DNS.
-static char stored_http_request[1000];                  // Buffer para armazenar a requisição HTTP antes de ser enviada.                            
+
+static void http_worker_run(async_context_t *context, async_when_pending_worker_t *worker);
+
+/// Worker que inicia as requisições enfileiradas, executado no contexto do lwIP.
+static async_when_pending_worker_t http_worker = { .do_work = http_worker_run };
+
+/**
+ * @brief Interpreta a resposta recebida, como o laço principal fazia.
+ * 
+ * @param response Resposta completa terminada em '\0'.
+ * @param result Resultado a preencher.
+ */
+static void http_parse_response(const char *response, http_result_t *result) {
+    // Procura pelo início do corpo da resposta (após o header)
+    const char *body = strstr(response, "\r\n\r\n");
+    if (body == NULL) {
+        result->code = HTTP_RESULT_NO_BODY;
+        return;
+    }
+    body += 4;
+    while (*body == ' ' || *body == '\n' || *body == '\r')
+        body++;
+    snprintf(result->body, sizeof(result->body), "%s", body);
+
+    if (strcmp(body, "11") == 0)
+        result->code = HTTP_RESULT_OPEN;
+    else if (strcmp(body, "12") == 0)
+        result->code = HTTP_RESULT_HUMAN;
+    else if (strcmp(body, "02") == 0)
+        result->code = HTTP_RESULT_NOISE;
+    else if (strcmp(body, "03") == 0)
+        result->code = HTTP_RESULT_ALARM;
+    else
+        result->code = HTTP_RESULT_UNKNOWN;
+}
+
+/**
+ * @brief Encerra a requisição em andamento e publica o resultado para o laço principal.
+ * 
+ * Devolve os blocos ao pool e agenda o worker para iniciar o próximo pedido da fila.
+ * 
+ * @param received true se a conexão terminou normalmente e a resposta deve ser interpretada.
+ */
+static void http_finish(bool received) {
+    http_result_t result = { .code = HTTP_RESULT_FAILED };
+
+    if (received && response_buffer != NULL) {
+        response_buffer[response_length] = '\0'; // Termina a string
+        http_parse_response(response_buffer, &result);
+    }
+    if (!ring_push(&result_ring, &result))
+        printf("Fila de respostas cheia, resultado descartado\n");
+
+    pool_free(&request_pool, request_buffer);
+    pool_free(&response_pool, response_buffer);
+    request_buffer = NULL;
+    response_buffer = NULL;
+    response_length = 0;
+    connection_active = false;
+
+    if (!ring_is_empty(&command_ring))
+        async_context_set_work_pending(cyw43_arch_async_context(), &http_worker);
+}
+
+/**
+ * @brief Callback de erro da conexão TCP (reset, timeout ou abort).
+ * 
+ * O lwIP já liberou o PCB quando este callback é chamado.
+ * 
+ * @param arg Argumento passado (não utilizado).
+ * @param err Código de erro da biblioteca lwIP.
+ */
+static void http_client_error(void *arg, err_t err) {
+    printf("Erro na conexão com o servidor: %d\n", err);
+    http_finish(false);
+}
+
+/**
+ * @brief Callback periódico da conexão (a cada HTTP_POLL_INTERVAL ticks).
+ * 
+ * Limita a duração da conexão, do SYN ao fechamento: um servidor que aceita e nunca
+ * responde prenderia a única conexão e todos os pedidos seguintes. A conexão é abortada
+ * e http_client_error() publica HTTP_RESULT_FAILED.
+ * 
+ * @param arg Argumento passado (não utilizado).
+ * @param tpcb Ponteiro para o controle do bloco TCP.
+ * @return err_t ERR_ABRT se a conexão foi abortada.
+ */
+static err_t http_poll(void *arg, struct tcp_pcb *tpcb) {
+    if (++poll_count < HTTP_TIMEOUT_POLLS)
+        return ERR_OK;
+    printf("Servidor não respondeu em %d ms, abortando a conexão\n", HTTP_TIMEOUT_POLLS * HTTP_POLL_INTERVAL * 500);
+    tcp_abort(tpcb);
+    return ERR_ABRT;
+}
 
 /**
  * @brief Callback para processamento da resposta HTTP.
  * 
- * Copia os dados da resposta para o buffer global e identifica o fim da transmissão.
+ * Copia os dados da resposta para o bloco da conexão e, quando o servidor fecha a
+ * conexão, publica o resultado interpretado.
  * 
  * @param arg Argumento passado (não utilizado).
  * @param tpcb Ponteiro para o controle do bloco TCP.
@@ -36,38 +169,28 @@ err_t http_client_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_
     printf("Callback HTTP\n");
     if (p == NULL) {
         // O servidor fechou a conexão: resposta completa.
-        response_buffer[response_length] = '\0'; // Termina a string
-
-        // Se desejar, extraia o corpo da resposta:
-        char *body = strstr(response_buffer, "\r\n\r\n");
-        if (body) {
-            // DESCOMENTAR CASO SEJA NECESSÁRIO USAR O MONITOR SERIAL PARA DEPURAR O CÓDIGO
-            // printf("Corpo da resposta:\n%s\n", body + 4);
-        } else {
-            // DESCOMENTAR CASO SEJA NECESSÁRIO USAR O MONITOR SERIAL PARA DEPURAR O CÓDIGO
-            // printf("Corpo da resposta não encontrado\n");
-        }
-
-        // Seta a flag para que o arquivo main.c saiba que a resposta está pronta
-        response_complete = true;
-
-        // Fecha a conexão
-        tcp_close(tpcb);
-        return ERR_OK;
+        tcp_err(tpcb, NULL);
+        tcp_poll(tpcb, NULL, 0);
+        err_t close_err = tcp_close(tpcb);
+        if (close_err != ERR_OK)
+            tcp_abort(tpcb);    // Sem memória para o FIN: os callbacks já foram removidos e nada liberaria o PCB
+        http_finish(true);
+        return close_err == ERR_OK ? ERR_OK : ERR_ABRT;
     }
 
-    // Copia os dados de todos os pbufs para o buffer global
+    // Copia os dados de todos os pbufs para o buffer da resposta
     struct pbuf *q;
     for (q = p; q != NULL; q = q->next) {
-        if (response_length + q->len < RESPONSE_BUFFER_SIZE) {
+        if (response_buffer != NULL && response_length + q->len < HTTP_RESPONSE_SIZE) {
             memcpy(response_buffer + response_length, q->payload, q->len);
             response_length += q->len;
         } else {
-            printf("Buffer de resposta cheio\n");
+            printf("Buffer de resposta cheio, resposta truncada\n");
             break;
         }
     }
 
+    tcp_recved(tpcb, p->tot_len);
     pbuf_free(p);
     return ERR_OK;
 }
@@ -75,7 +198,7 @@ err_t http_client_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_
 /**
  * @brief Callback chamado ao estabelecer conexão TCP com o servidor.
  * 
- * Envia a requisição HTTP armazenada no buffer `stored_http_request`.
+ * Envia a requisição HTTP e devolve o bloco dela ao pool (o lwIP copia os dados).
  * 
  * @param arg Argumento passado (não utilizado).
  * @param tpcb Ponteiro para o controle do bloco TCP.
@@ -90,10 +213,13 @@ err_t custom_tcp_connected_callback(void *arg, struct tcp_pcb *tpcb, err_t err)
 
     printf("Conexão TCP estabelecida. Enviando requisição...\n");
 
-    if (tcp_write(tpcb, stored_http_request, strlen(stored_http_request), TCP_WRITE_FLAG_COPY) != ERR_OK) {
+    if (tcp_write(tpcb, request_buffer, strlen(request_buffer), TCP_WRITE_FLAG_COPY) != ERR_OK) {
         printf("Erro ao enviar a requisição HTTP\n");
-        return ERR_VAL;
+        tcp_abort(tpcb);    // Chama http_client_error(), que libera os blocos e encerra a requisição
+        return ERR_ABRT;    // Único retorno que faz o lwIP parar de usar o PCB
     }
+    pool_free(&request_pool, request_buffer);
+    request_buffer = NULL;
     tcp_output(tpcb); // Envia imediatamente
     printf("Requisição HTTP enviada\n");
 
@@ -113,6 +239,7 @@ err_t custom_tcp_connected_callback(void *arg, struct tcp_pcb *tpcb, err_t err)
 void dns_callback(const char *name, const ip_addr_t *ipaddr, void *callback_arg) {
     if (ipaddr == NULL) {
         printf("Erro ao resolver o endereço do servidor\n");
+        http_finish(false);
         return;
     }
     printf("DNS resolvido: %s\n", ipaddr_ntoa(ipaddr));
@@ -120,29 +247,44 @@ void dns_callback(const char *name, const ip_addr_t *ipaddr, void *callback_arg)
     struct tcp_pcb *pcb = tcp_new();
     if (!pcb) {
         printf("Erro ao criar PCB\n");
+        http_finish(false);
         return;
     }
     tcp_recv(pcb, http_client_callback);
+    tcp_err(pcb, http_client_error);
+    poll_count = 0;
+    tcp_poll(pcb, http_poll, HTTP_POLL_INTERVAL);
     if (tcp_connect(pcb, ipaddr, 80, custom_tcp_connected_callback) != ERR_OK) {
         printf("Erro ao conectar ao servidor\n");
+        tcp_err(pcb, NULL);
+        tcp_poll(pcb, NULL, 0);
+        if (tcp_close(pcb) != ERR_OK)
+            tcp_abort(pcb);
+        http_finish(false);
         return;
     }
 }
 
 /**
- * @brief Envia uma requisição HTTP personalizada.
+ * @brief Inicia a requisição de um pedido (contexto do lwIP).
  * 
- * Formata a requisição HTTP e inicia a resolução de DNS para envio ao servidor.
+ * Formata a requisição HTTP em um bloco do pool e inicia a resolução de DNS para
+ * envio ao servidor. Qualquer falha é publicada como HTTP_RESULT_FAILED.
  * 
- * @param method Método HTTP (GET, POST, etc.).
- * @param endpoint URL do recurso requisitado.
- * @param body Corpo da requisição (caso aplicável).
+ * @param command Pedido retirado de command_ring.
  */
-void send_custom_http_request(const char *method, const char *endpoint, const char *body) {
+static void http_start(const http_command_t *command) {
+    connection_active = true;
     response_length = 0;
-    memset(response_buffer, 0, RESPONSE_BUFFER_SIZE);
+    request_buffer = pool_alloc(&request_pool);
+    response_buffer = pool_alloc(&response_pool);
+    if (request_buffer == NULL || response_buffer == NULL) {
+        printf("Sem blocos livres para a requisição HTTP\n");
+        http_finish(false);
+        return;
+    }
 
-    snprintf(stored_http_request, sizeof(stored_http_request),
+    int length = snprintf(request_buffer, HTTP_REQUEST_SIZE,
              "%s %s HTTP/1.1\r\n"
              "Host: %s\r\n"
              "User-Agent: Security-Sonar/1.0\r\n"
@@ -152,34 +294,89 @@ void send_custom_http_request(const char *method, const char *endpoint, const ch
              "Connection: close\r\n"
              "Cache-Control: no-cache\r\n\r\n"
              "%s",
-             method, endpoint, SERVER_URL, strlen(body), body);
+             command->method, command->endpoint, command->host, (int)strlen(command->body), command->body);
+    if (length < 0 || length >= HTTP_REQUEST_SIZE) {
+        printf("Requisição HTTP excede %d bytes\n", HTTP_REQUEST_SIZE);
+        http_finish(false);
+        return;
+    }
 
-    //printf("Preparando requisição HTTP:\n%s\n", stored_http_request);
+    //printf("Preparando requisição HTTP:\n%s\n", request_buffer);
 
-    err_t err = dns_gethostbyname(SERVER_URL, &server_ip, dns_callback, NULL);
+    err_t err = dns_gethostbyname(command->host, &server_ip, dns_callback, NULL);
     if (err == ERR_OK) {
         // printf("DNS já resolvido. Conectando...\n");
-        dns_callback(SERVER_URL, &server_ip, NULL);  // Chama diretamente o DNS callback para iniciar a conexão
+        dns_callback(command->host, &server_ip, NULL);  // Chama diretamente o DNS callback para iniciar a conexão
     } else if (err == ERR_INPROGRESS) {
         // printf("Resolução do DNS em andamento...\n");
     } else {
-        // printf("Erro ao iniciar a resolução do DNS\n");
+        printf("Erro ao iniciar a resolução do DNS\n");
+        http_finish(false);
+    }
+}
+
+/**
+ * @brief Worker do async_context: inicia o próximo pedido se não houver conexão ativa.
+ */
+static void http_worker_run(async_context_t *context, async_when_pending_worker_t *worker) {
+    http_command_t command;
+    if (!connection_active && ring_pop(&command_ring, &command))
+        http_start(&command);
+}
+
+/**
+ * @brief Enfileira uma requisição HTTP personalizada.
+ * 
+ * Pode ser chamada do laço principal sem cyw43_arch_lwip_begin/end: o pedido é copiado
+ * para command_ring e executado pelo worker no contexto do lwIP. O resultado chega
+ * por wifi_poll_result().
+ * 
+ * @param method Método HTTP (GET, POST, etc.).
+ * @param endpoint URL do recurso requisitado.
+ * @param body Corpo da requisição (caso aplicável).
+ * @return true se o pedido foi enfileirado; nesse caso exatamente um resultado será
+ *         publicado, com ou sem sucesso.
+ */
+bool send_custom_http_request(const char *method, const char *endpoint, const char *body) {
+    http_command_t command;
+
+    if (snprintf(command.method, sizeof(command.method), "%s", method) >= (int)sizeof(command.method) ||
+        snprintf(command.host, sizeof(command.host), "%s", config_get()->server_url) >= (int)sizeof(command.host) ||
+        snprintf(command.endpoint, sizeof(command.endpoint), "%s", endpoint) >= (int)sizeof(command.endpoint) ||
+        snprintf(command.body, sizeof(command.body), "%s", body) >= (int)sizeof(command.body)) {
+        printf("Requisição HTTP não cabe no pedido\n");
+        return false;
+    }
+
+    if (!ring_push(&command_ring, &command)) {
+        printf("Fila de requisições cheia\n");
+        return false;
     }
+    async_context_set_work_pending(cyw43_arch_async_context(), &http_worker);
+    return true;
 }
 
 /**
  * @brief Conecta a uma rede Wi-Fi.
  * 
- * Inicializa o chip Wi-Fi, conecta ao SSID fornecido e exibe o endereço IP obtido.
+ * Inicializa o chip Wi-Fi (apenas na primeira chamada), conecta ao SSID fornecido e
+ * exibe o endereço IP obtido. Pode ser chamada novamente para trocar de rede quando
+ * as credenciais forem alteradas na configuração.
  * 
  * @param ssid Nome da rede Wi-Fi.
  * @param pass Senha da rede Wi-Fi.
  */
-void wifi_connect(char *ssid, char *pass) {
-    if (cyw43_arch_init()) {
-        printf("Erro ao inicializar o Wi-Fi\n");
+void wifi_connect(const char *ssid, const char *pass) {
+    static bool initialized = false;
+
+    if (!initialized) {
+        if (cyw43_arch_init()) {
+            printf("Erro ao inicializar o Wi-Fi\n");
+        }
+        cyw43_arch_enable_sta_mode();
+        async_context_add_when_pending_worker(cyw43_arch_async_context(), &http_worker);
+        initialized = true;
     }
-    cyw43_arch_enable_sta_mode();
     printf("Conectando ao Wi-Fi...\n");
 
     if (cyw43_arch_wifi_connect_timeout_ms(ssid, pass, CYW43_AUTH_WPA2_AES_PSK, 10000)) {
@@ -189,45 +386,24 @@ void wifi_connect(char *ssid, char *pass) {
         uint8_t *ip_address = (uint8_t*)&(cyw43_state.netif[0].ip_addr.addr);
         printf("Endereço IP %d.%d.%d.%d\n", ip_address[0], ip_address[1], ip_address[2], ip_address[3]);
     }
-    printf("Wi-Fi conectado!\n");
-}
-
-/**
- * @brief Retorna se a resposta HTTP foi completamente recebida.
- * @return true se a resposta estiver completa, false caso contrário.
- */
-bool is_response_complete() {
-    return response_complete;
-}
-
-/**
- * @brief Define o status de resposta completa.
- * @param status Novo valor da flag de resposta completa.
- */
-void set_response_complete(bool status) {
-    response_complete = status;
-}
 
-/**
- * @brief Retorna o buffer contendo a resposta do servidor.
- * @return Ponteiro para o buffer de resposta.
- */
-char *get_response_buffer() {
-    return response_buffer;
+    // Pools e buffers do lwIP aparecem em mem_report()
+    pool_init(&request_pool);
+    pool_init(&response_pool);
+    mem_register("wifi", "http_rings", sizeof(command_ring_slots) + sizeof(result_ring_slots));
+    mem_register("lwip", "heap", MEM_SIZE);
+    mem_register("lwip", "pbuf_pool", PBUF_POOL_SIZE * PBUF_POOL_BUFSIZE);
+    printf("Wi-Fi conectado!\n");
 }
 
 /**
- * @brief Define um novo buffer de resposta ou reseta o buffer atual.
- * @param buffer Novo buffer de resposta ou NULL para resetar.
- * @return Ponteiro para o buffer atualizado.
+ * @brief Retira o próximo resultado de requisição, se houver.
+ * 
+ * @param result Destino do resultado.
+ * @return true se um resultado foi retirado.
  */
-char *set_response_buffer(char *buffer) {
-    if (buffer != NULL) {
-        memcpy(response_buffer, buffer, RESPONSE_BUFFER_SIZE);
-    } else {
-        memset(response_buffer, 0, RESPONSE_BUFFER_SIZE);
-    }
-    return response_buffer;
+bool wifi_poll_result(http_result_t *result) {
+    return ring_pop(&result_ring, result);
 }
 
 /**
@@ -239,15 +415,32 @@ void wifi_cleanup() {
 
 /**
  * @brief Envia uma requisição HTTP para alterar um status no servidor.
+ * 
+ * Quando o relógio já foi sincronizado por SNTP, o instante do evento é enviado em
+ * `?ts=` (milissegundos UTC), permitindo ao servidor ordenar eventos atrasados ou
+ * reenviados e medir a latência real.
+ * 
  * @param status Novo status a ser enviado.
+ * @param captured_us Instante do evento, em time_us_64() (ex.: mic_capture_time_us()).
+ * @return true se a requisição foi enfileirada (ver send_custom_http_request()).
  */
-void send_request_to_change_status(int status) {
-        
+bool send_request_to_change_status(int status, uint64_t captured_us) {
+
     // Cria um buffer para armazenar a URL formatada
-    char url[50];  // Tamanho suficiente para a URL
-    sprintf(url, "/log/status/1/%d", status);
-        
+    char url[HTTP_URL_SIZE];
+    uint64_t timestamp_ms = timesync_to_epoch_ms(captured_us);
+    int length;
+    if (timestamp_ms != 0)
+        length = snprintf(url, sizeof(url), "/log/status/%u/%d?ts=%llu", config_get()->room_id, status,
+                          (unsigned long long)timestamp_ms);
+    else
+        length = snprintf(url, sizeof(url), "/log/status/%u/%d", config_get()->room_id, status);
+    if (length < 0 || length >= (int)sizeof(url)) {
+        printf("URL de status excede %d bytes\n", HTTP_URL_SIZE);
+        return false;
+    }
+
     // Manda a requisição HTTP
-    printf(url);
-    send_custom_http_request("GET", url, "{}");
-}
\ No newline at end of file
+    printf("%s\n", url);
+    return send_custom_http_request("GET", url, "{}");
+}
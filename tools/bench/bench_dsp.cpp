@@ -0,0 +1,210 @@
+/**
+ * @file bench_dsp.cpp
+ * @brief Compara cadeias de include/dsp_pipeline.hpp pelo custo por bloco no host.
+ *
+ * Cada cadeia processa os mesmos blocos sintéticos do ADC (senoide de 5 kHz com ruído
+ * sobre o DC do microfone) e o relatório mostra ciclos e nanossegundos por bloco, além
+ * da saída final, para que os estágios possam ser comparados antes de gravar a placa.
+ * A cadeia do firmware também é medida pela API C de src/dsp.cpp, compilada aqui sem
+ * alterações, e o nível dela deve ser o mesmo do laço da versão 1.x (o programa termina
+ * com erro se não for), pois os limiares gravados na configuração usam essa escala.
+ *
+ * Os ciclos são do processador do host (TSC no x86); servem para comparar cadeias
+ * entre si, não para estimar o tempo absoluto no RP2040.
+ *
+ * Uso:
+ *   ./bench_dsp [blocos]
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2026
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+#include "include/dsp.h"
+#include "include/dsp_pipeline.hpp"
+#include "include/mic.h"
+
+namespace {
+
+constexpr std::size_t BLOCK_SETS = 64;              // Blocos distintos, percorridos em ciclo
+constexpr double TWO_PI = 6.283185307179586;
+
+/// Contador de ciclos do host (ou nanossegundos, se não houver TSC).
+inline uint64_t cycles_now() {
+#ifdef BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline uint64_t ns_now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// Impede que o compilador descarte o resultado de uma cadeia.
+template <typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/// Blocos sintéticos: DC de 1,69 V, 5 kHz com 0,1 V de pico e ruído de ±8 LSB.
+std::vector<uint16_t> make_adc_blocks() {
+    std::vector<uint16_t> samples(BLOCK_SETS * SAMPLES);
+    uint32_t seed = 12345;
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        double t = static_cast<double>(i) / MIC_SAMPLE_RATE_HZ;
+        double volts = 1.69 + 0.1 * std::sin(TWO_PI * 5000.0 * t);
+        int noise = static_cast<int>(seed >> 28) - 8;
+        samples[i] = static_cast<uint16_t>(volts / 3.3 * 4096.0 + noise);
+    }
+    return samples;
+}
+
+template <typename Sample>
+std::vector<Sample> convert(const std::vector<uint16_t> &adc);
+
+template <>
+std::vector<float> convert(const std::vector<uint16_t> &adc) {
+    std::vector<float> out(adc.size());
+    for (std::size_t i = 0; i < adc.size(); ++i)
+        out[i] = (static_cast<int>(adc[i]) - 2048) * (3.3f / 4096.f);
+    return out;
+}
+
+template <>
+std::vector<uint16_t> convert(const std::vector<uint16_t> &adc) {
+    return adc;
+}
+
+float output_value(float power) { return power; }
+float output_value(const dsp::detection &d) { return d.power; }
+
+/**
+ * @brief Mede uma cadeia e imprime uma linha do relatório.
+ *
+ * A potência final é convertida para volts como 2 x raiz x volts_per_unit: para
+ * legacy_level é o nível do firmware, para rms e band_energy é 2 x o RMS sem DC.
+ */
+template <typename Chain>
+void measure(const char *name, const std::vector<uint16_t> &adc, std::size_t blocks) {
+    using sample = typename Chain::sample_type;
+    std::vector<sample> input = convert<sample>(adc);
+    Chain chain;
+    float last = 0.f;
+
+    for (std::size_t b = 0; b < BLOCK_SETS; ++b)
+        keep(chain.process(&input[b * SAMPLES]));
+
+    uint64_t start_ns = ns_now();
+    uint64_t start = cycles_now();
+    for (std::size_t b = 0; b < blocks; ++b) {
+        auto out = chain.process(&input[(b % BLOCK_SETS) * SAMPLES]);
+        keep(out);
+        last = output_value(out);
+    }
+    uint64_t cycles = cycles_now() - start;
+    uint64_t ns = ns_now() - start_ns;
+
+    float level = 2.f * std::sqrt(last) * Chain::format::volts_per_unit;
+    std::printf("%-48s %4zu %9.1f %9.1f %9.4f\n", name, Chain::block_size,
+                static_cast<double>(cycles) / blocks, static_cast<double>(ns) / blocks, level);
+}
+
+/// Laço da versão 1.x (mic_power() + ADC_ADJUST), referência do nível do firmware.
+float measure_legacy(const std::vector<uint16_t> &adc, std::size_t blocks) {
+    float level = 0.f;
+    uint64_t start_ns = ns_now();
+    uint64_t start = cycles_now();
+    for (std::size_t b = 0; b < blocks; ++b) {
+        const uint16_t *buffer = &adc[(b % BLOCK_SETS) * SAMPLES];
+        float avg = 0.f;
+        for (unsigned i = 0; i < SAMPLES; ++i)
+            avg += buffer[i] * buffer[i];
+        avg /= SAMPLES;
+        avg = std::sqrt(avg);
+        level = 2.f * std::fabs(avg * 3.3f / 4096.f - 1.65f);
+        keep(level);
+    }
+    uint64_t cycles = cycles_now() - start;
+    uint64_t ns = ns_now() - start_ns;
+    std::printf("%-48s %4d %9.1f %9.1f %9.4f\n", "1.x: mic_power() em float", SAMPLES,
+                static_cast<double>(cycles) / blocks, static_cast<double>(ns) / blocks, level);
+    return level;
+}
+
+/// Cadeia do firmware pela API C (inclui a escolha da instância e a raiz do nível).
+float measure_firmware(const std::vector<uint16_t> &adc, std::size_t blocks) {
+    float level = 0.f;
+    dsp_set_threshold(0.1f);
+    uint64_t start_ns = ns_now();
+    uint64_t start = cycles_now();
+    for (std::size_t b = 0; b < blocks; ++b) {
+        bool detected = dsp_detect(&adc[(b % BLOCK_SETS) * SAMPLES], SAMPLES, &level);
+        keep(detected);
+    }
+    uint64_t cycles = cycles_now() - start;
+    uint64_t ns = ns_now() - start_ns;
+    std::printf("%-48s %4d %9.1f %9.1f %9.4f\n", "firmware: dsp_detect() (src/dsp.cpp)", SAMPLES,
+                static_cast<double>(cycles) / blocks, static_cast<double>(ns) / blocks, level);
+    return level;
+}
+
+template <std::size_t N, typename... Stages>
+using adc_chain = dsp::pipeline<dsp::adc12, N, MIC_SAMPLE_RATE_HZ, Stages...>;
+
+template <std::size_t N, typename... Stages>
+using float_chain = dsp::pipeline<dsp::f32, N, MIC_SAMPLE_RATE_HZ, Stages...>;
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t blocks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    if (blocks == 0) {
+        std::fprintf(stderr, "Uso: %s [blocos]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint16_t> adc = make_adc_blocks();
+
+    std::printf("%zu blocos, %u amostras/s; nível em volts: 2 x |RMS - 1,65| com DC (~0,08), 2 x RMS sem DC (~0,141)\n",
+                blocks, MIC_SAMPLE_RATE_HZ);
+    std::printf("%-48s %4s %9s %9s %9s\n", "cadeia", "N", "ciclos", "ns", "nível");
+
+    float legacy = measure_legacy(adc, blocks);
+    measure<adc_chain<SAMPLES, dsp::legacy_level, dsp::detector<>>>("adc12: legacy_level > det", adc, blocks);
+    measure<adc_chain<SAMPLES, dsp::rms>>("adc12: rms", adc, blocks);
+    measure<adc_chain<SAMPLES, dsp::dc_blocker<7>, dsp::rms>>("adc12: dc_blocker<7> > rms", adc, blocks);
+    measure<adc_chain<SAMPLES, dsp::decimator<2>, dsp::dc_blocker<7>, dsp::rms, dsp::detector<>>>(
+        "adc12: decimator<2> > dc_blocker<7> > rms > det", adc, blocks);
+    measure<adc_chain<100, dsp::decimator<2>, dsp::dc_blocker<7>, dsp::rms, dsp::detector<>>>(
+        "adc12: decimator<2> > dc_blocker<7> > rms > det", adc, blocks);
+    measure<adc_chain<50, dsp::decimator<2>, dsp::dc_blocker<7>, dsp::rms, dsp::detector<>>>(
+        "adc12: decimator<2> > dc_blocker<7> > rms > det", adc, blocks);
+    measure<adc_chain<SAMPLES, dsp::decimator<4>, dsp::dc_blocker<6>, dsp::rms>>(
+        "adc12: decimator<4> > dc_blocker<6> > rms", adc, blocks);
+    measure<adc_chain<SAMPLES, dsp::dc_blocker<7>, dsp::band_energy<5000>>>(
+        "adc12: dc_blocker<7> > band_energy<5000>", adc, blocks);
+    measure<float_chain<SAMPLES, dsp::dc_blocker<7>, dsp::rms>>("f32: dc_blocker<7> > rms", adc, blocks);
+    measure<float_chain<SAMPLES, dsp::decimator<2>, dsp::dc_blocker<7>, dsp::rms, dsp::detector<>>>(
+        "f32: decimator<2> > dc_blocker<7> > rms > det", adc, blocks);
+    float firmware = measure_firmware(adc, blocks);
+
+    if (std::fabs(firmware - legacy) > 1e-3f) {
+        std::printf("nível do firmware (%.4f) difere da versão 1.x (%.4f)\n", firmware, legacy);
+        return 1;
+    }
+    return 0;
+}
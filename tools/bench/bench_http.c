@@ -0,0 +1,239 @@
+/**
+ * @file bench_http.c
+ * @brief Gerador de carga para medir a latência ponta a ponta do cliente HTTP do firmware.
+ *
+ * Compila src/wifi.c no host sobre o shim de sockets e dispara requisições
+ * `/log/status/{sala}/{status}` em sequência contra o servidor local
+ * (tools/stand_in_server.py), como o laço principal faria. Ao final reporta
+ * p50/p90/p99 e como cada falha foi percebida pelo firmware. O relógio do firmware
+ * é ajustado pela hora do host, então o servidor também mede a latência a partir do
+ * `?ts=` de cada evento.
+ *
+ * Uso:
+ *   python3 tools/stand_in_server.py --port 8080 &
+ *   ./bench_http --port 8080 --requests 2000
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#define FIRMWARE_TIMEOUT_MS 11000   // http_poll() aborta a conexão após 10 s, mais a folga de um tick
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "include/wifi.h"
+#include "include/config.h"
+#include "include/pool.h"
+#include "include/timesync.h"
+#include "shim/shim.h"
+
+/// Resultado de uma requisição, do ponto de vista do laço principal do firmware.
+enum outcome {
+    OUTCOME_OK = 0,         // Corpo com um dos códigos conhecidos ("11", "12", "02", "03")
+    OUTCOME_UNKNOWN_CODE,   // HTTP_RESULT_UNKNOWN
+    OUTCOME_NO_BODY,        // HTTP_RESULT_NO_BODY
+    OUTCOME_FAILED,         // HTTP_RESULT_FAILED: DNS, conexão resetada ou falta de blocos
+    OUTCOME_TIMEOUT,        // Nenhum resultado publicado dentro do prazo
+    OUTCOME_STUCK,          // Nem o timeout do firmware (http_poll()) publicou um resultado
+    OUTCOME_NOT_SENT,       // send_request_to_change_status() recusou a requisição
+    OUTCOME_COUNT
+};
+
+static const char *outcome_names[OUTCOME_COUNT] = {
+    "ok", "código desconhecido", "sem corpo", "falha de conexão", "timeout", "conexão presa", "não enviada"
+};
+
+static sonar_config_t config;   // Configuração vista por src/wifi.c
+
+/**
+ * @brief Substitui src/config.c: o benchmark não usa flash.
+ */
+const sonar_config_t *config_get() {
+    return &config;
+}
+
+/**
+ * @brief Converte o resultado publicado por src/wifi.c em uma categoria do relatório.
+ */
+static enum outcome classify_result(const http_result_t *result) {
+    switch (result->code) {
+    case HTTP_RESULT_OPEN:
+    case HTTP_RESULT_HUMAN:
+    case HTTP_RESULT_NOISE:
+    case HTTP_RESULT_ALARM:   return OUTCOME_OK;
+    case HTTP_RESULT_UNKNOWN: return OUTCOME_UNKNOWN_CODE;
+    case HTTP_RESULT_NO_BODY: return OUTCOME_NO_BODY;
+    default:                  return OUTCOME_FAILED;
+    }
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(const uint64_t *sorted, size_t count, double p) {
+    if (count == 0)
+        return 0.0;
+    size_t index = (size_t)(p * (double)(count - 1) + 0.5);
+    return (double)sorted[index] / 1000.0;
+}
+
+/**
+ * @brief Aguarda o resultado da requisição em andamento.
+ * @return true se wifi_poll_result() entregou um resultado dentro do prazo.
+ */
+static bool wait_result(uint64_t start_us, uint64_t timeout_us, http_result_t *result) {
+    while (!wifi_poll_result(result)) {
+        uint64_t elapsed = shim_now_us() - start_us;
+        if (elapsed >= timeout_us)
+            return false;
+        int remaining_ms = (int)((timeout_us - elapsed + 999) / 1000);
+        shim_poll(remaining_ms < 10 ? remaining_ms : 10);
+    }
+    return true;
+}
+
+/**
+ * @brief Descarta o resultado atrasado de uma requisição que estourou o prazo.
+ *
+ * O firmware publica um resultado para toda requisição em até FIRMWARE_TIMEOUT_MS;
+ * sem esperar por ele o resultado seria atribuído à requisição seguinte.
+ *
+ * @param start_us Instante em que a requisição foi enviada.
+ * @return false se o firmware não publicou nada dentro do próprio timeout.
+ */
+static bool drain_late_result(uint64_t start_us) {
+    http_result_t late;
+    return wait_result(start_us, (uint64_t)FIRMWARE_TIMEOUT_MS * 1000u, &late);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Uso: %s [opções]\n"
+            "  --host HOST         servidor (padrão 127.0.0.1)\n"
+            "  --port PORTA        porta do servidor (padrão 8080)\n"
+            "  --room ID           sala enviada na URL (padrão 1)\n"
+            "  --requests N        quantidade de requisições (padrão 1000)\n"
+            "  --interval-us US    pausa entre requisições (padrão 0)\n"
+            "  --timeout-ms MS     prazo por requisição (padrão 2000)\n"
+            "  --write-fail-every N  faz 1 em cada N tcp_write falhar (padrão 0, nunca)\n"
+            "  --verbose           mantém os printf do firmware\n",
+            program);
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    unsigned port = 8080, room = 1, interval_us = 0, timeout_ms = 2000, write_fail_every = 0;
+    size_t requests = 1000;
+    bool verbose = false;
+
+    static const struct option options[] = {
+        { "host",        required_argument, NULL, 'h' },
+        { "port",        required_argument, NULL, 'p' },
+        { "room",        required_argument, NULL, 'r' },
+        { "requests",    required_argument, NULL, 'n' },
+        { "interval-us", required_argument, NULL, 'i' },
+        { "timeout-ms",  required_argument, NULL, 't' },
+        { "write-fail-every", required_argument, NULL, 'w' },
+        { "verbose",     no_argument,       NULL, 'v' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h:p:r:n:i:t:w:v", options, NULL)) != -1) {
+        switch (opt) {
+        case 'h': host = optarg; break;
+        case 'p': port = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'r': room = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'n': requests = strtoul(optarg, NULL, 10); break;
+        case 'i': interval_us = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 't': timeout_ms = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'w': write_fail_every = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'v': verbose = true; break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+
+    if (requests == 0 || strlen(host) >= sizeof(config.server_url)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    snprintf(config.server_url, sizeof(config.server_url), "%s", host);
+    config.room_id = (uint16_t)room;
+    shim_set_port((uint16_t)port);
+    shim_set_write_failures(write_fail_every);
+
+    // O relatório vai para o stdout original; os printf do firmware são descartados
+    FILE *report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL)
+        return 1;
+
+    uint64_t *latencies = malloc(requests * sizeof(uint64_t));
+    size_t counts[OUTCOME_COUNT] = { 0 };
+    size_t completed = 0;
+    if (latencies == NULL)
+        return 1;
+
+    wifi_connect("bench", "bench");
+
+    // Equivalente à resposta SNTP: o host já está sincronizado
+    struct timespec realtime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    timesync_set_system_time((uint32_t)realtime.tv_sec, (uint32_t)(realtime.tv_nsec / 1000));
+
+    uint64_t bench_start = shim_now_us();
+    for (size_t i = 0; i < requests; i++) {
+        uint64_t start = shim_now_us();
+        bool sent = send_request_to_change_status(i % 2 == 0 ? 2 : 3, start);
+
+        enum outcome outcome;
+        http_result_t result;
+        if (!sent) {
+            outcome = OUTCOME_NOT_SENT;
+        } else if (wait_result(start, (uint64_t)timeout_ms * 1000u, &result)) {
+            uint64_t latency = shim_now_us() - start;
+            outcome = classify_result(&result);
+            if (outcome == OUTCOME_OK)
+                latencies[completed++] = latency;
+        } else {
+            outcome = drain_late_result(start) ? OUTCOME_TIMEOUT : OUTCOME_STUCK;
+        }
+        counts[outcome]++;
+
+        if (interval_us > 0) {
+            struct timespec ts = { interval_us / 1000000u, (long)(interval_us % 1000000u) * 1000L };
+            nanosleep(&ts, NULL);
+        }
+    }
+    double elapsed_s = (double)(shim_now_us() - bench_start) / 1e6;
+
+    qsort(latencies, completed, sizeof(uint64_t), compare_u64);
+
+    fprintf(report, "requisições:  %zu em %.2f s (%.1f req/s)\n", requests, elapsed_s, (double)requests / elapsed_s);
+    for (int i = 0; i < OUTCOME_COUNT; i++)
+        fprintf(report, "  %-22s %zu\n", outcome_names[i], counts[i]);
+    fprintf(report, "latência (ms): p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+            percentile_ms(latencies, completed, 0.50), percentile_ms(latencies, completed, 0.90),
+            percentile_ms(latencies, completed, 0.99), percentile_ms(latencies, completed, 1.0));
+    fprintf(report, "PCBs abertos ao final: %d\n", shim_open_pcbs());
+    fflush(report);
+
+    // Relatório de pools (high-water mark) pelo próprio firmware
+    fflush(stdout);
+    if (dup2(fileno(report), STDOUT_FILENO) >= 0)
+        mem_report();
+    fflush(stdout);
+    fclose(report);
+
+    free(latencies);
+    return counts[OUTCOME_OK] == requests ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file bench_stream.c
+ * @brief Mede se o streaming de src/stream.c acompanha a captura contínua do microfone.
+ *
+ * Compila src/stream.c no host sobre o shim de sockets e simula o laço de captura:
+ * a cada período (por padrão o tempo de `--samples` amostras na taxa do ADC) um bloco
+ * é reservado com stream_acquire(), preenchido com um sinal sintético e entregue com
+ * stream_submit(), como mic.c faz com o DMA. Entre capturas o shim processa a rede.
+ *
+ * O relatório mostra quantas capturas foram enviadas ou descartadas por falta de
+ * bloco, o tempo gasto no lado da captura (que nunca deve esperar pela rede) e se
+ * algum bloco sem cópia foi reutilizado antes da confirmação do receptor; termina com
+ * erro se nenhum bloco seguiu sem cópia (LWIP_NETIF_TX_SINGLE_PBUF ligado, por exemplo).
+ *
+ * Uso:
+ *   python3 tools/stream_listener.py --port 5005 &
+ *   ./bench_stream --port 5005 --seconds 5 --mode raw
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "include/stream.h"
+#include "include/pool.h"
+#include "include/timesync.h"
+#include "shim/shim.h"
+
+#define ADC_CLOCK_HZ    48000000.0      // clk_adc do RP2040
+#define TWO_PI          6.283185307179586
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Uso: %s [opções]\n"
+            "  --host HOST         receptor (padrão 127.0.0.1)\n"
+            "  --port PORTA        porta do receptor (padrão 5005)\n"
+            "  --mode MODO         raw ou level (padrão raw)\n"
+            "  --samples N         amostras por captura, até %d (padrão %d)\n"
+            "  --period-us US      intervalo entre capturas (padrão: duração da captura)\n"
+            "  --seconds S         duração do teste (padrão 5)\n"
+            "  --verbose           mantém os printf do firmware\n",
+            program, SAMPLES, SAMPLES);
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    unsigned port = 5005, samples = SAMPLES, period_us = 0;
+    double seconds = 5.0;
+    uint8_t mode = STREAM_MODE_RAW;
+    bool verbose = false;
+
+    static const struct option options[] = {
+        { "host",      required_argument, NULL, 'h' },
+        { "port",      required_argument, NULL, 'p' },
+        { "mode",      required_argument, NULL, 'm' },
+        { "samples",   required_argument, NULL, 'n' },
+        { "period-us", required_argument, NULL, 'i' },
+        { "seconds",   required_argument, NULL, 's' },
+        { "verbose",   no_argument,       NULL, 'v' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h:p:m:n:i:s:v", options, NULL)) != -1) {
+        switch (opt) {
+        case 'h': host = optarg; break;
+        case 'p': port = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'm': mode = strcmp(optarg, "level") == 0 ? STREAM_MODE_LEVEL : STREAM_MODE_RAW; break;
+        case 'n': samples = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'i': period_us = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 's': seconds = strtod(optarg, NULL); break;
+        case 'v': verbose = true; break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+
+    if (samples == 0 || samples > SAMPLES || seconds <= 0.0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Mesma taxa do firmware: uma conversão a cada (1 + ADC_CLOCK_DIV) ciclos de clk_adc
+    double sample_rate = ADC_CLOCK_HZ / (1.0 + ADC_CLOCK_DIV);
+    if (period_us == 0)
+        period_us = (unsigned)(samples * 1e6 / sample_rate + 0.5);
+
+    // O relatório vai para o stdout original; os printf do firmware são descartados
+    FILE *report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL)
+        return 1;
+
+    struct timespec realtime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    timesync_set_system_time((uint32_t)realtime.tv_sec, (uint32_t)(realtime.tv_nsec / 1000));
+
+    stream_init();
+    stream_configure(mode, host, (uint16_t)port);
+
+    uint16_t fallback[SAMPLES];                 // Papel do adc_buffer quando não há bloco
+    uint64_t captures = 0, submitted = 0, skipped = 0;
+    uint64_t capture_cost_max = 0, capture_cost_total = 0;
+    double phase = 0.0;
+
+    uint64_t bench_start = shim_now_us();
+    uint64_t bench_end = bench_start + (uint64_t)(seconds * 1e6);
+    uint64_t next_capture = bench_start;
+
+    while (shim_now_us() < bench_end) {
+        // Lado da captura: não pode depender do estado da rede
+        uint64_t start = shim_now_us();
+        stream_frame_t *frame = stream_acquire();
+        uint16_t *buffer = frame != NULL ? frame->samples : fallback;
+        for (unsigned i = 0; i < samples; i++, phase += TWO_PI * 1000.0 / sample_rate)
+            buffer[i] = (uint16_t)(2048.0 + 600.0 * sin(phase));
+        if (frame != NULL) {
+            stream_submit(frame, samples, start);
+            submitted++;
+        } else {
+            skipped++;
+        }
+        uint64_t cost = shim_now_us() - start;
+        capture_cost_total += cost;
+        if (cost > capture_cost_max)
+            capture_cost_max = cost;
+        captures++;
+
+        // Até a próxima captura, a rede (contexto do lwIP) processa os eventos
+        next_capture += period_us;
+        do {
+            shim_poll(0);
+        } while (shim_now_us() < next_capture);
+    }
+    double elapsed_s = (double)(shim_now_us() - bench_start) / 1e6;
+
+    // Deixa os últimos blocos serem confirmados antes do relatório de pools
+    uint64_t drain_end = shim_now_us() + 500000u;
+    while (shim_now_us() < drain_end)
+        shim_poll(10);
+
+    size_t frame_bytes = sizeof(stream_header_t) + (mode == STREAM_MODE_LEVEL
+        ? (samples + STREAM_LEVEL_DECIMATION - 1) / STREAM_LEVEL_DECIMATION : samples) * sizeof(uint16_t);
+
+    fprintf(report, "capturas:     %llu em %.2f s (período %u us, %.0f amostras/s)\n",
+            (unsigned long long)captures, elapsed_s, period_us, sample_rate);
+    fprintf(report, "  enviadas               %llu (%.1f kB/s)\n", (unsigned long long)submitted,
+            (double)submitted * frame_bytes / elapsed_s / 1000.0);
+    fprintf(report, "  sem bloco livre        %llu (%.2f%%)\n", (unsigned long long)skipped,
+            captures ? 100.0 * (double)skipped / (double)captures : 0.0);
+    fprintf(report, "custo da captura (us): média %.2f  max %llu\n",
+            captures ? (double)capture_cost_total / (double)captures : 0.0, (unsigned long long)capture_cost_max);
+    fprintf(report, "blocos enviados sem cópia: %u\n", shim_zero_copy_writes());
+    fprintf(report, "blocos reutilizados antes da confirmação: %u\n", shim_zero_copy_violations());
+    fflush(report);
+
+    fflush(stdout);
+    if (dup2(fileno(report), STDOUT_FILENO) >= 0)
+        mem_report();
+    fflush(stdout);
+    fclose(report);
+
+    return shim_zero_copy_violations() == 0 && shim_zero_copy_writes() > 0 && submitted > 0 ? 0 : 1;
+}
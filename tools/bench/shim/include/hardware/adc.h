@@ -0,0 +1,11 @@
+/**
+ * @file adc.h
+ * @brief Substituto de hardware/adc.h: os benchmarks geram as amostras no host.
+ */
+
+#ifndef SHIM_HARDWARE_ADC_H
+#define SHIM_HARDWARE_ADC_H
+
+#include "hardware/sync.h"
+
+#endif
@@ -0,0 +1,11 @@
+/**
+ * @file dma.h
+ * @brief Substituto de hardware/dma.h: os benchmarks não usam DMA.
+ */
+
+#ifndef SHIM_HARDWARE_DMA_H
+#define SHIM_HARDWARE_DMA_H
+
+#include "hardware/sync.h"
+
+#endif
@@ -0,0 +1,16 @@
+/**
+ * @file sync.h
+ * @brief Substituto de hardware/sync.h: o shim roda em um único thread.
+ */
+
+#ifndef SHIM_HARDWARE_SYNC_H
+#define SHIM_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif
@@ -0,0 +1,17 @@
+/**
+ * @file sntp.h
+ * @brief Subconjunto de lwip/apps/sntp.h: no host o benchmark ajusta o relógio diretamente.
+ */
+
+#ifndef SHIM_LWIP_SNTP_H
+#define SHIM_LWIP_SNTP_H
+
+#include "lwip/err.h"
+
+#define SNTP_OPMODE_POLL    0
+
+static inline void sntp_setoperatingmode(u8_t mode) { (void)mode; }
+static inline void sntp_setservername(u8_t idx, const char *server) { (void)idx; (void)server; }
+static inline void sntp_init(void) { }
+
+#endif
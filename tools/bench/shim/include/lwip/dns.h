@@ -0,0 +1,18 @@
+/**
+ * @file dns.h
+ * @brief Subconjunto de lwip/dns.h usado pelo shim de host.
+ *
+ * A resolução é síncrona (getaddrinfo), então dns_gethostbyname() sempre
+ * retorna ERR_OK ou ERR_ARG e nunca chama o callback.
+ */
+
+#ifndef SHIM_LWIP_DNS_H
+#define SHIM_LWIP_DNS_H
+
+#include "lwip/ip_addr.h"
+
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *callback_arg);
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg);
+
+#endif
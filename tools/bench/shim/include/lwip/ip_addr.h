@@ -0,0 +1,20 @@
+/**
+ * @file ip_addr.h
+ * @brief Subconjunto de lwip/ip_addr.h usado pelo shim de host (apenas IPv4).
+ */
+
+#ifndef SHIM_LWIP_IP_ADDR_H
+#define SHIM_LWIP_IP_ADDR_H
+
+#include "lwip/err.h"
+
+typedef struct {
+    u32_t addr;                 // Endereço IPv4 em ordem de rede
+} ip_addr_t;
+
+#define IPADDR_TYPE_V4      0
+#define IPADDR_TYPE_ANY     46
+
+char *ipaddr_ntoa(const ip_addr_t *addr);
+
+#endif
@@ -0,0 +1,16 @@
+/**
+ * @file opt.h
+ * @brief Subconjunto de lwip/opt.h: expõe as opções do lwipopts.h do firmware no host.
+ */
+
+#ifndef SHIM_LWIP_OPT_H
+#define SHIM_LWIP_OPT_H
+
+#include "lwipopts.h"
+
+// Mesma fórmula do lwIP para IPv4 + Ethernet (PBUF_IP_HLEN + PBUF_TRANSPORT_HLEN + PBUF_LINK_HLEN)
+#ifndef PBUF_POOL_BUFSIZE
+#define PBUF_POOL_BUFSIZE   ((TCP_MSS + 20 + 20 + 14 + 3) & ~3)
+#endif
+
+#endif
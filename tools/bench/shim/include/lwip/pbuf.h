@@ -0,0 +1,23 @@
+/**
+ * @file pbuf.h
+ * @brief Subconjunto de lwip/pbuf.h usado pelo shim de host.
+ *
+ * Cada pbuf do shim é um único bloco alocado com malloc (a cadeia tem um elemento).
+ */
+
+#ifndef SHIM_LWIP_PBUF_H
+#define SHIM_LWIP_PBUF_H
+
+#include "lwip/err.h"
+
+struct pbuf {
+    struct pbuf *next;
+    void        *payload;
+    u16_t        tot_len;
+    u16_t        len;
+};
+
+u8_t pbuf_free(struct pbuf *p);
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset);
+
+#endif
@@ -0,0 +1,27 @@
+/**
+ * @file async_context.h
+ * @brief Subconjunto de pico/async_context.h: workers "when pending" executados por shim_poll().
+ */
+
+#ifndef SHIM_PICO_ASYNC_CONTEXT_H
+#define SHIM_PICO_ASYNC_CONTEXT_H
+
+#include <stdbool.h>
+
+typedef struct async_context async_context_t;
+
+typedef struct async_when_pending_worker {
+    struct async_when_pending_worker *next;
+    void (*do_work)(async_context_t *context, struct async_when_pending_worker *worker);
+    volatile bool work_pending;
+    void *user_data;
+} async_when_pending_worker_t;
+
+struct async_context {
+    async_when_pending_worker_t *when_pending_list;
+};
+
+bool async_context_add_when_pending_worker(async_context_t *context, async_when_pending_worker_t *worker);
+void async_context_set_work_pending(async_context_t *context, async_when_pending_worker_t *worker);
+
+#endif
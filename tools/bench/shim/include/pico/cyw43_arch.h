@@ -0,0 +1,39 @@
+/**
+ * @file cyw43_arch.h
+ * @brief Substituto de pico/cyw43_arch.h para compilar src/wifi.c no host.
+ *
+ * O "chip" Wi-Fi é sempre considerado conectado; as funções de lock do lwIP
+ * não fazem nada porque o shim roda em um único thread, e os workers do
+ * async_context são executados no início de cada shim_poll().
+ */
+
+#ifndef SHIM_PICO_CYW43_ARCH_H
+#define SHIM_PICO_CYW43_ARCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/ip_addr.h"
+#include "pico/async_context.h"
+
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+
+struct netif {
+    ip_addr_t ip_addr;
+};
+
+typedef struct {
+    struct netif netif[2];
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+int  cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_sta_mode(void);
+int  cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout);
+void cyw43_arch_lwip_begin(void);
+void cyw43_arch_lwip_end(void);
+async_context_t *cyw43_arch_async_context(void);
+
+#endif
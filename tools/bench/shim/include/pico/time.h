@@ -0,0 +1,14 @@
+/**
+ * @file time.h
+ * @brief Substituto de pico/time.h: o timer de 64 bits é o relógio monotônico do host.
+ */
+
+#ifndef SHIM_PICO_TIME_H
+#define SHIM_PICO_TIME_H
+
+#include <stdint.h>
+#include "shim/shim.h"
+
+static inline uint64_t time_us_64(void) { return shim_now_us(); }
+
+#endif
@@ -0,0 +1,545 @@
+/**
+ * @file shim.c
+ * @brief Implementação da API raw TCP/DNS do lwIP sobre sockets POSIX.
+ *
+ * Permite compilar src/wifi.c sem alterações no host e dirigi-lo contra o servidor
+ * local (tools/stand_in_server.py). Cada tcp_pcb é um socket não bloqueante; os
+ * callbacks do firmware são chamados a partir de shim_poll(), como o lwIP faria a
+ * partir da interrupção do CYW43.
+ *
+ * O tcp_sent só é chamado quando o receptor confirma os bytes (SIOCOUTQ no Linux),
+ * como no lwIP. Dados escritos sem TCP_WRITE_FLAG_COPY têm um hash guardado e
+ * conferido na confirmação: se o firmware reutilizar o buffer antes disso, a violação
+ * aparece em shim_zero_copy_violations(). Como no lwIP, LWIP_NETIF_TX_SINGLE_PBUF do
+ * lwipopts.h transforma toda escrita em cópia, e shim_zero_copy_writes() conta as que
+ * de fato ficaram sem cópia.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#if defined(__linux__)
+#include <linux/sockios.h>
+#endif
+
+#include "lwip/tcp.h"
+#include "lwip/dns.h"
+#include "pico/cyw43_arch.h"
+#include "shim.h"
+
+#define SHIM_MAX_PCBS       16                      // Conexões simultâneas suportadas
+#define SHIM_SNDBUF         (8 * 1460)              // Igual a TCP_SND_BUF do lwipopts.h
+#define SHIM_RECV_CHUNK     1460                    // Tamanho máximo de cada pbuf entregue
+#define SHIM_MAX_REFS       32                      // Escritas sem cópia aguardando confirmação (como TCP_SND_QUEUELEN)
+#define SHIM_TCP_TMR_US     500000u                 // Timer lento do TCP (TCP_SLOW_INTERVAL), unidade de tcp_poll()
+
+enum pcb_state { PCB_FREE = 0, PCB_NEW, PCB_CONNECTING, PCB_CONNECTED, PCB_CLOSED };
+
+struct tcp_pcb {
+    enum pcb_state   state;
+    int              fd;
+    void            *arg;
+    tcp_recv_fn      recv;
+    tcp_sent_fn      sent;
+    tcp_err_fn       err;
+    tcp_connected_fn connected;
+    tcp_poll_fn      poll;
+    u8_t             poll_interval;                 // Em ticks de SHIM_TCP_TMR_US
+    uint64_t         next_poll_us;
+    uint8_t          tx[SHIM_SNDBUF];               // Dados aceitos por tcp_write() e ainda não enviados
+    size_t           tx_length;
+    size_t           unacked;                       // Entregues ao kernel e ainda não confirmados
+    uint64_t         written;                       // Total aceito por tcp_write()
+    uint64_t         acked;                         // Total confirmado pelo receptor
+    struct {
+        const void  *data;
+        u16_t        len;
+        uint32_t     hash;
+        uint64_t     end;                           // Valor de `written` após a escrita
+    } refs[SHIM_MAX_REFS];                          // Escritas sem cópia, em ordem
+    unsigned         ref_head;
+    unsigned         ref_count;
+};
+
+static struct tcp_pcb pcbs[SHIM_MAX_PCBS];
+static uint16_t port_override = 0;                  // Porta usada no lugar da pedida pelo firmware (0 = não altera)
+
+cyw43_t cyw43_state;
+
+static async_context_t context;                     // Contexto "do lwIP" do shim
+static unsigned zero_copy_violations = 0;           // Buffers sem cópia alterados antes da confirmação
+static unsigned zero_copy_writes = 0;               // Escritas aceitas sem TCP_WRITE_FLAG_COPY
+static unsigned write_fail_every = 0;               // Uma em cada N chamadas de tcp_write falha (0 = nunca)
+static unsigned write_calls = 0;
+
+/**
+ * @brief Redireciona todas as conexões para a porta informada.
+ *
+ * O firmware sempre conecta na porta 80; o servidor local normalmente não roda como root.
+ */
+void shim_set_port(uint16_t port) {
+    port_override = port;
+}
+
+/**
+ * @brief Faz uma em cada `every` chamadas de tcp_write() devolver ERR_MEM.
+ *
+ * Exercita os caminhos de erro do firmware que dependem de o lwIP recusar a escrita.
+ */
+void shim_set_write_failures(unsigned every) {
+    write_fail_every = every;
+    write_calls = 0;
+}
+
+/**
+ * @brief Relógio monotônico em microssegundos.
+ */
+uint64_t shim_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/**
+ * @brief Quantidade de PCBs ainda em uso (útil para detectar vazamentos no firmware).
+ */
+int shim_open_pcbs() {
+    int count = 0;
+    for (int i = 0; i < SHIM_MAX_PCBS; i++)
+        if (pcbs[i].state != PCB_FREE)
+            count++;
+    return count;
+}
+
+/**
+ * @brief Hash FNV-1a usado para conferir os buffers sem cópia.
+ */
+static uint32_t shim_hash(const void *data, size_t len) {
+    const uint8_t *bytes = data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+unsigned shim_zero_copy_violations() {
+    return zero_copy_violations;
+}
+
+unsigned shim_zero_copy_writes() {
+    return zero_copy_writes;
+}
+
+static void pcb_release(struct tcp_pcb *pcb) {
+    if (pcb->fd >= 0)
+        close(pcb->fd);
+    memset(pcb, 0, sizeof(*pcb));
+    pcb->fd = -1;
+}
+
+/**
+ * @brief Encerra o PCB por erro: como no lwIP, o PCB é liberado antes do callback de erro.
+ */
+static void pcb_fail(struct tcp_pcb *pcb, err_t err) {
+    tcp_err_fn callback = pcb->err;
+    void *arg = pcb->arg;
+    pcb_release(pcb);
+    if (callback)
+        callback(arg, err);
+}
+
+/**
+ * @brief Envia ao kernel o máximo possível do buffer de transmissão.
+ */
+static void pcb_flush(struct tcp_pcb *pcb) {
+    while (pcb->state == PCB_CONNECTED && pcb->tx_length > 0) {
+        ssize_t n = send(pcb->fd, pcb->tx, pcb->tx_length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                pcb_fail(pcb, ERR_RST);
+            return;
+        }
+        memmove(pcb->tx, pcb->tx + n, pcb->tx_length - (size_t)n);
+        pcb->tx_length -= (size_t)n;
+        pcb->unacked += (size_t)n;
+    }
+}
+
+/**
+ * @brief Chama o callback de tcp_poll() a cada `poll_interval` ticks do timer lento.
+ *
+ * Como no tcp_slowtmr do lwIP, vale para conexões em andamento e estabelecidas; se o
+ * callback abortar o PCB ele já foi liberado e nada mais é feito.
+ *
+ * @return Microssegundos até a próxima chamada (UINT64_MAX se não houver).
+ */
+static uint64_t pcb_check_poll(struct tcp_pcb *pcb) {
+    if (pcb->poll == NULL || pcb->poll_interval == 0 ||
+        (pcb->state != PCB_CONNECTING && pcb->state != PCB_CONNECTED))
+        return UINT64_MAX;
+
+    uint64_t now = shim_now_us();
+    if (now >= pcb->next_poll_us) {
+        pcb->next_poll_us = now + (uint64_t)pcb->poll_interval * SHIM_TCP_TMR_US;
+        if (pcb->poll(pcb->arg, pcb) == ERR_ABRT || pcb->state == PCB_FREE)
+            return UINT64_MAX;
+    }
+    return pcb->next_poll_us - now;
+}
+
+/**
+ * @brief Verifica o que o receptor confirmou e notifica tcp_sent.
+ *
+ * Sem SIOCOUTQ, tudo o que o kernel aceitou é tratado como confirmado.
+ */
+static void pcb_check_acks(struct tcp_pcb *pcb) {
+    if (pcb->state != PCB_CONNECTED || pcb->unacked == 0)
+        return;
+
+    int outq = 0;
+#ifdef SIOCOUTQ
+    if (ioctl(pcb->fd, SIOCOUTQ, &outq) < 0)
+        outq = 0;
+#endif
+    if ((size_t)outq >= pcb->unacked)
+        return;
+
+    size_t acked = pcb->unacked - (size_t)outq;
+    pcb->unacked = (size_t)outq;
+    pcb->acked += acked;
+
+    while (pcb->ref_count > 0 && pcb->refs[pcb->ref_head].end <= pcb->acked) {
+        if (shim_hash(pcb->refs[pcb->ref_head].data, pcb->refs[pcb->ref_head].len) != pcb->refs[pcb->ref_head].hash)
+            zero_copy_violations++;
+        pcb->ref_head = (pcb->ref_head + 1) % SHIM_MAX_REFS;
+        pcb->ref_count--;
+    }
+
+    while (acked > 0 && pcb->state == PCB_CONNECTED && pcb->sent) {
+        u16_t chunk = acked > UINT16_MAX ? UINT16_MAX : (u16_t)acked;
+        acked -= chunk;
+        pcb->sent(pcb->arg, pcb, chunk);
+    }
+}
+
+struct tcp_pcb *tcp_new(void) {
+    for (int i = 0; i < SHIM_MAX_PCBS; i++) {
+        if (pcbs[i].state == PCB_FREE) {
+            memset(&pcbs[i], 0, sizeof(pcbs[i]));
+            pcbs[i].state = PCB_NEW;
+            pcbs[i].fd = -1;
+            return &pcbs[i];
+        }
+    }
+    return NULL;
+}
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type) {
+    (void)type;
+    return tcp_new();
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg)           { pcb->arg = arg; }
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv)   { pcb->recv = recv; }
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent)   { pcb->sent = sent; }
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err)      { pcb->err = err; }
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval) {
+    pcb->poll = poll;
+    pcb->poll_interval = interval;
+    pcb->next_poll_us = shim_now_us() + (uint64_t)interval * SHIM_TCP_TMR_US;
+}
+void tcp_recved(struct tcp_pcb *pcb, u16_t len)        { (void)pcb; (void)len; }
+
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, tcp_connected_fn connected) {
+    struct sockaddr_in addr;
+    int one = 1;
+
+    pcb->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (pcb->fd < 0)
+        return ERR_MEM;
+    fcntl(pcb->fd, F_SETFL, fcntl(pcb->fd, F_GETFL) | O_NONBLOCK);
+    setsockopt(pcb->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ipaddr->addr;
+    addr.sin_port = htons(port_override ? port_override : port);
+
+    pcb->connected = connected;
+    pcb->state = PCB_CONNECTING;
+    if (connect(pcb->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        pcb_release(pcb);
+        return ERR_RTE;
+    }
+    return ERR_OK;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags) {
+    if (pcb->state != PCB_CONNECTED)
+        return ERR_CONN;
+    if (write_fail_every > 0 && ++write_calls % write_fail_every == 0)
+        return ERR_MEM;
+    if (len > tcp_sndbuf(pcb))
+        return ERR_MEM;
+#if LWIP_NETIF_TX_SINGLE_PBUF
+    apiflags |= TCP_WRITE_FLAG_COPY;                // Como no tcp_write do lwIP
+#endif
+    if (!(apiflags & TCP_WRITE_FLAG_COPY)) {
+        // O shim copia mesmo assim, mas confere na confirmação que o buffer não mudou
+        if (pcb->ref_count == SHIM_MAX_REFS)
+            return ERR_MEM;
+        unsigned slot = (pcb->ref_head + pcb->ref_count++) % SHIM_MAX_REFS;
+        pcb->refs[slot].data = dataptr;
+        pcb->refs[slot].len = len;
+        pcb->refs[slot].hash = shim_hash(dataptr, len);
+        pcb->refs[slot].end = pcb->written + len;
+        zero_copy_writes++;
+    }
+    memcpy(pcb->tx + pcb->tx_length, dataptr, len);
+    pcb->tx_length += len;
+    pcb->written += len;
+    return ERR_OK;
+}
+
+err_t tcp_output(struct tcp_pcb *pcb) {
+    pcb_flush(pcb);
+    return ERR_OK;
+}
+
+u16_t tcp_sndbuf(const struct tcp_pcb *pcb) {
+    // Como no lwIP, o espaço só volta quando o receptor confirma
+    return (u16_t)(SHIM_SNDBUF - pcb->tx_length - pcb->unacked);
+}
+
+err_t tcp_close(struct tcp_pcb *pcb) {
+    // Fechado dentro de um callback: o socket é liberado aqui mesmo, shim_poll() ignora o PCB
+    pcb_release(pcb);
+    return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb) {
+    struct linger lin = { .l_onoff = 1, .l_linger = 0 };
+    if (pcb->fd >= 0)
+        setsockopt(pcb->fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+    pcb_fail(pcb, ERR_ABRT);
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+    u8_t count = 0;
+    while (p) {
+        struct pbuf *next = p->next;
+        free(p);
+        p = next;
+        count++;
+    }
+    return count;
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset) {
+    u16_t copied = 0;
+    for (; p != NULL && copied < len; p = p->next) {
+        if (offset >= p->len) {
+            offset -= p->len;
+            continue;
+        }
+        u16_t chunk = p->len - offset;
+        if (chunk > len - copied)
+            chunk = len - copied;
+        memcpy((uint8_t *)dataptr + copied, (const uint8_t *)p->payload + offset, chunk);
+        copied += chunk;
+        offset = 0;
+    }
+    return copied;
+}
+
+char *ipaddr_ntoa(const ip_addr_t *addr) {
+    static char text[INET_ADDRSTRLEN];
+    struct in_addr in = { .s_addr = addr->addr };
+    inet_ntop(AF_INET, &in, text, sizeof(text));
+    return text;
+}
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg) {
+    struct addrinfo hints, *result;
+    (void)found;
+    (void)callback_arg;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(hostname, NULL, &hints, &result) != 0)
+        return ERR_ARG;
+    addr->addr = ((struct sockaddr_in *)result->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(result);
+    return ERR_OK;
+}
+
+async_context_t *cyw43_arch_async_context(void) { return &context; }
+
+bool async_context_add_when_pending_worker(async_context_t *ctx, async_when_pending_worker_t *worker) {
+    worker->next = ctx->when_pending_list;
+    ctx->when_pending_list = worker;
+    return true;
+}
+
+void async_context_set_work_pending(async_context_t *ctx, async_when_pending_worker_t *worker) {
+    (void)ctx;
+    worker->work_pending = true;
+}
+
+/**
+ * @brief Executa os workers com trabalho pendente, como a interrupção do async_context.
+ * @return true se algum worker foi executado.
+ */
+static bool run_pending_workers(void) {
+    bool ran = false;
+    for (async_when_pending_worker_t *worker = context.when_pending_list; worker != NULL; worker = worker->next) {
+        if (worker->work_pending) {
+            worker->work_pending = false;
+            worker->do_work(&context, worker);
+            ran = true;
+        }
+    }
+    return ran;
+}
+
+int  cyw43_arch_init(void)                  { return 0; }
+void cyw43_arch_deinit(void)                { }
+void cyw43_arch_enable_sta_mode(void)       { }
+void cyw43_arch_lwip_begin(void)            { }
+void cyw43_arch_lwip_end(void)              { }
+
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout) {
+    (void)ssid; (void)pw; (void)auth; (void)timeout;
+    cyw43_state.netif[0].ip_addr.addr = htonl(INADDR_LOOPBACK);
+    return 0;
+}
+
+/**
+ * @brief Trata um evento de leitura/escrita de um PCB.
+ */
+static void pcb_service(struct tcp_pcb *pcb, short revents) {
+    if (pcb->state == PCB_CONNECTING) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(pcb->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            pcb_fail(pcb, ERR_RST);
+            return;
+        }
+        pcb->state = PCB_CONNECTED;
+        // Como no tcp_in.c do lwIP, só ERR_ABRT interrompe (a aplicação já abortou o PCB);
+        // qualquer outro retorno é ignorado e a conexão continua aberta
+        if (pcb->connected)
+            pcb->connected(pcb->arg, pcb, ERR_OK);
+        return;
+    }
+
+    if (pcb->state != PCB_CONNECTED)
+        return;
+
+    if (revents & POLLOUT)
+        pcb_flush(pcb);
+
+    if (pcb->state == PCB_CONNECTED && (revents & (POLLIN | POLLHUP | POLLERR))) {
+        struct pbuf *p = malloc(sizeof(struct pbuf) + SHIM_RECV_CHUNK);
+        if (p == NULL)
+            return;
+        p->next = NULL;
+        p->payload = p + 1;
+        ssize_t n = recv(pcb->fd, p->payload, SHIM_RECV_CHUNK, 0);
+        if (n > 0) {
+            p->len = p->tot_len = (u16_t)n;
+            if (pcb->recv)
+                pcb->recv(pcb->arg, pcb, p, ERR_OK);
+            else
+                pbuf_free(p);
+        } else {
+            free(p);
+            if (n == 0) {
+                // Fim de fluxo: o lwIP entrega p == NULL e espera que a aplicação feche
+                if (pcb->recv)
+                    pcb->recv(pcb->arg, pcb, NULL, ERR_OK);
+                else
+                    tcp_close(pcb);
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                pcb_fail(pcb, ERR_RST);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Processa eventos de rede pendentes, disparando os callbacks do firmware.
+ *
+ * @param timeout_ms Tempo máximo de espera por um evento.
+ * @return Quantidade de PCBs com eventos processados.
+ */
+int shim_poll(int timeout_ms) {
+    struct pollfd fds[SHIM_MAX_PCBS];
+    struct tcp_pcb *owners[SHIM_MAX_PCBS];
+    nfds_t count = 0;
+
+    while (run_pending_workers())
+        ;
+
+    for (int i = 0; i < SHIM_MAX_PCBS; i++)
+        pcb_check_acks(&pcbs[i]);
+
+    for (int i = 0; i < SHIM_MAX_PCBS; i++) {
+        uint64_t until_poll = pcb_check_poll(&pcbs[i]);
+        if (until_poll != UINT64_MAX && timeout_ms > (int)(until_poll / 1000u))
+            timeout_ms = (int)(until_poll / 1000u);
+    }
+
+    for (int i = 0; i < SHIM_MAX_PCBS; i++) {
+        struct tcp_pcb *pcb = &pcbs[i];
+        if (pcb->fd < 0 || (pcb->state != PCB_CONNECTING && pcb->state != PCB_CONNECTED))
+            continue;
+        if (pcb->unacked > 0 && timeout_ms > 1)
+            timeout_ms = 1;                         // Confirmações não geram eventos no poll()
+        fds[count].fd = pcb->fd;
+        fds[count].events = POLLIN;
+        if (pcb->state == PCB_CONNECTING || pcb->tx_length > 0)
+            fds[count].events |= POLLOUT;
+        fds[count].revents = 0;
+        owners[count++] = pcb;
+    }
+
+    if (count == 0) {
+        if (timeout_ms > 0) {
+            struct timespec ts = { timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+        }
+        return 0;
+    }
+
+    int ready = poll(fds, count, timeout_ms);
+    if (ready <= 0)
+        return 0;
+
+    for (nfds_t i = 0; i < count; i++) {
+        // O PCB pode ter sido fechado por um callback anterior nesta mesma rodada
+        if (fds[i].revents != 0 && owners[i]->fd == fds[i].fd)
+            pcb_service(owners[i], fds[i].revents);
+    }
+    return ready;
+}
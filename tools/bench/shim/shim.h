@@ -0,0 +1,22 @@
+/**
+ * @file shim.h
+ * @brief Controle do shim de host que substitui o lwIP/CYW43 nos benchmarks.
+ *
+ * @author Jhonatas Anthony Dantas Araújo
+ * @date 2026
+ */
+
+#ifndef SHIM_H
+#define SHIM_H
+
+#include <stdint.h>
+
+void shim_set_port(uint16_t port);
+void shim_set_write_failures(unsigned every);
+int shim_poll(int timeout_ms);
+int shim_open_pcbs();
+uint64_t shim_now_us();
+unsigned shim_zero_copy_violations();
+unsigned shim_zero_copy_writes();
+
+#endif
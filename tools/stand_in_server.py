@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+Servidor local que substitui embarcatech.icy-tree-310a.workers.dev em testes.
+
+Implementa apenas o endpoint usado pelo firmware, ``GET /log/status/{sala}/{status}``,
+respondendo com os mesmos códigos no corpo:
+
+    "11"  casa aberta (o administrador liberou a sala)
+    "12"  mudança humana (o administrador alterou o status manualmente)
+    "02"  status alterado para Barulho
+    "03"  status alterado para Alarme
+
+Quando a requisição traz ``?ts=<ms UTC>`` (instante da captura no firmware), o
+servidor registra a latência entre o evento e a chegada e mostra p50/p99 ao sair.
+
+Falhas podem ser injetadas para exercitar o tratamento de erros do cliente: atraso
+fixo/aleatório, respostas HTTP 500, códigos desconhecidos, envio do corpo em pedaços
+lentos, conexões encerradas sem resposta e conexões resetadas.
+
+Uso:
+    python3 tools/stand_in_server.py --port 8080 --delay-ms 20 --drop-rate 0.01
+
+Para apontar a placa para o servidor, envie pela serial: ``set server <ip do host>``
+(o firmware sempre usa a porta 80, então rode com ``--port 80``).
+
+@author Jhonatas Anthony Dantas Araújo
+@date 2026
+"""
+
+import argparse
+import asyncio
+import random
+import re
+import signal
+import socket
+import struct
+import sys
+import time
+from collections import Counter
+
+STATUS_PATH = re.compile(r"^/log/status/(\d+)/(\d+)(?:\?(.*))?$")
+TIMESTAMP = re.compile(r"(?:^|&)ts=(\d+)")
+
+
+class StandInServer:
+    def __init__(self, args):
+        self.args = args
+        self.random = random.Random(args.seed)
+        self.rooms = {}             # sala -> último status recebido
+        self.stats = Counter()
+        self.event_latencies = []  # chegada - ts, em ms
+
+    def response_code(self, room, status):
+        """Decide o código devolvido, imitando o servidor real."""
+        if self.args.mode == "open":
+            self.rooms[room] = 1
+            return "11"
+        if self.args.mode == "human":
+            self.rooms[room] = 1
+            return "12"
+        if status == 1:
+            self.rooms[room] = 1
+            return "11"
+        self.rooms[room] = status
+        return "%02d" % status
+
+    async def handle(self, reader, writer):
+        self.stats["conexões"] += 1
+        try:
+            head = await asyncio.wait_for(reader.readuntil(b"\r\n\r\n"), timeout=self.args.read_timeout)
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, asyncio.TimeoutError, ConnectionError):
+            self.stats["requisição incompleta"] += 1
+            writer.close()
+            return
+
+        arrival_ms = time.time() * 1000.0
+        lines = head.decode("latin-1").split("\r\n")
+        method, path = (lines[0].split(" ") + ["", ""])[:2]
+        length = 0
+        for line in lines[1:]:
+            name, _, value = line.partition(":")
+            if name.strip().lower() == "content-length":
+                length = int(value.strip() or 0)
+        if length:
+            await reader.readexactly(length)
+
+        delay = self.args.delay_ms + self.random.uniform(0, self.args.jitter_ms)
+        if delay > 0:
+            await asyncio.sleep(delay / 1000.0)
+
+        roll = self.random.random()
+        if roll < self.args.drop_rate:
+            self.stats["encerrada sem resposta"] += 1
+            writer.close()
+            return
+        roll -= self.args.drop_rate
+        if roll < self.args.reset_rate:
+            self.stats["resetada"] += 1
+            sock = writer.get_extra_info("socket")
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+            writer.transport.abort()
+            return
+        roll -= self.args.reset_rate
+
+        match = STATUS_PATH.match(path)
+        if match is not None and match.group(3):
+            timestamp = TIMESTAMP.search(match.group(3))
+            if timestamp:
+                self.event_latencies.append(arrival_ms - int(timestamp.group(1)))
+
+        if method != "GET" or match is None:
+            status_line, body = "404 Not Found", "not found"
+            self.stats["404"] += 1
+        elif roll < self.args.error_rate:
+            status_line, body = "500 Internal Server Error", "error"
+            self.stats["500"] += 1
+        elif roll < self.args.error_rate + self.args.bad_code_rate:
+            status_line, body = "200 OK", "99"
+            self.stats["código desconhecido"] += 1
+        else:
+            status_line = "200 OK"
+            body = self.response_code(int(match.group(1)), int(match.group(2)))
+            self.stats[body] += 1
+
+        payload = ("HTTP/1.1 %s\r\n"
+                   "Content-Type: text/plain\r\n"
+                   "Content-Length: %d\r\n"
+                   "Connection: close\r\n\r\n%s" % (status_line, len(body), body)).encode()
+
+        try:
+            chunks = max(1, self.args.slow_chunks)
+            size = (len(payload) + chunks - 1) // chunks
+            for offset in range(0, len(payload), size):
+                writer.write(payload[offset:offset + size])
+                await writer.drain()
+                if chunks > 1:
+                    await asyncio.sleep(self.args.chunk_delay_ms / 1000.0)
+            writer.close()
+            await writer.wait_closed()
+        except ConnectionError:
+            self.stats["cliente desconectou"] += 1
+
+    def report(self):
+        for name, count in sorted(self.stats.items()):
+            print("  %-24s %d" % (name, count), file=sys.stderr)
+        if self.event_latencies:
+            ordered = sorted(self.event_latencies)
+            pick = lambda p: ordered[int(p * (len(ordered) - 1) + 0.5)]
+            print("  evento -> servidor (ms): p50 %.3f  p99 %.3f  max %.3f"
+                  % (pick(0.50), pick(0.99), ordered[-1]), file=sys.stderr)
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--mode", choices=("follow", "open", "human"), default="follow",
+                        help="follow: ecoa o status (02/03); open: sempre 11; human: sempre 12")
+    parser.add_argument("--delay-ms", type=float, default=0.0, help="atraso fixo antes de responder")
+    parser.add_argument("--jitter-ms", type=float, default=0.0, help="atraso aleatório adicional (0..jitter)")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="fração de respostas HTTP 500")
+    parser.add_argument("--bad-code-rate", type=float, default=0.0, help="fração de respostas com código desconhecido")
+    parser.add_argument("--drop-rate", type=float, default=0.0, help="fração de conexões fechadas sem resposta")
+    parser.add_argument("--reset-rate", type=float, default=0.0, help="fração de conexões resetadas (RST)")
+    parser.add_argument("--slow-chunks", type=int, default=1, help="divide a resposta em N pedaços")
+    parser.add_argument("--chunk-delay-ms", type=float, default=0.0, help="pausa entre os pedaços")
+    parser.add_argument("--read-timeout", type=float, default=10.0, help="prazo para receber a requisição (s)")
+    parser.add_argument("--seed", type=int, default=None)
+    return parser.parse_args()
+
+
+async def main():
+    args = parse_args()
+    stand_in = StandInServer(args)
+    server = await asyncio.start_server(stand_in.handle, args.host, args.port, backlog=256)
+    print("Servidor local em %s:%d" % (args.host, args.port), file=sys.stderr)
+
+    stop = asyncio.Event()
+    loop = asyncio.get_running_loop()
+    for sig in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(sig, stop.set)
+
+    async with server:
+        await stop.wait()
+    stand_in.report()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
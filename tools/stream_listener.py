@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Receptor da telemetria do microfone enviada pelo firmware (src/stream.c).
+
+Cada captura chega como um frame com cabeçalho de 32 bytes, little-endian:
+
+    magic u32 ("NRST")  type u8  decimation u8  count u16
+    sequence u32  dropped u32  capture_us u64  epoch_ms u64
+
+seguido de ``count`` valores u16: amostras do ADC (type 1, "raw") ou níveis RMS de
+``decimation`` amostras (type 2, "level"). A cada segundo o receptor mostra frames,
+taxa, lacunas de sequência, descartes informados pela placa e o nível em volts
+(mesmo nível de dsp_detect() no firmware: 2 * |RMS * 3.3 / 4096 - 1.65|, com o RMS das
+amostras brutas, DC incluído).
+
+Uso:
+    python3 tools/stream_listener.py --port 5005 --out capturas.csv
+
+Na placa (serial, ou UDP 4242 com ``<token>`` na frente): ``set stream_host <ip do host>`` e ``set stream raw``.
+``--read-delay-ms`` atrasa a leitura para testar o controle de fluxo.
+
+@author Jhonatas Anthony Dantas Araújo
+@date 2026
+"""
+
+import argparse
+import asyncio
+import math
+import signal
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<IBBHIIQQ")
+MAGIC = 0x5453524E
+FRAME_TYPES = {1: "raw", 2: "level"}
+
+
+def volts(value):
+    return 2.0 * abs(value * 3.3 / 4096.0 - 1.65)
+
+
+class Listener:
+    def __init__(self, args):
+        self.args = args
+        self.out = open(args.out, "w") if args.out else None
+        if self.out:
+            self.out.write("sequence,type,capture_us,epoch_ms,values\n")
+        self.reset_window()
+        self.total_frames = 0
+        self.total_gaps = 0
+
+    def reset_window(self):
+        self.window_start = time.monotonic()
+        self.frames = 0
+        self.bytes = 0
+        self.gaps = 0
+        self.level = 0.0
+        self.dropped = 0
+        self.latency_ms = None
+
+    def frame(self, header, values):
+        _, kind, decimation, count, sequence, dropped, capture_us, epoch_ms = header
+        if self.expected is not None and sequence != self.expected:
+            self.gaps += (sequence - self.expected) & 0xFFFFFFFF
+        self.expected = (sequence + 1) & 0xFFFFFFFF
+        self.frames += 1
+        self.bytes += HEADER.size + 2 * count
+        self.dropped = dropped
+        if count:
+            # RMS da captura com o DC, como dsp::legacy_level; nos frames "level" os valores já
+            # são RMS de grupos de amostras e o RMS deles é o da captura inteira
+            rms = math.sqrt(sum(v * v for v in values) / count)
+            self.level = max(self.level, volts(rms))
+        if epoch_ms:
+            self.latency_ms = time.time() * 1000.0 - epoch_ms
+        if self.out:
+            self.out.write("%d,%s,%d,%d,%s\n" % (sequence, FRAME_TYPES.get(kind, kind), capture_us, epoch_ms,
+                                                 " ".join(map(str, values))))
+
+    def report(self):
+        elapsed = max(time.monotonic() - self.window_start, 1e-6)
+        latency = "" if self.latency_ms is None else "  atraso %.1f ms" % self.latency_ms
+        print("%5d frames  %7.1f kB/s  lacunas %d  descartes na placa %d  nível %.3f V%s"
+              % (self.frames, self.bytes / elapsed / 1000.0, self.gaps, self.dropped, self.level, latency),
+              file=sys.stderr)
+        self.total_frames += self.frames
+        self.total_gaps += self.gaps
+        self.reset_window()
+
+    async def handle(self, reader, writer):
+        peer = writer.get_extra_info("peername")
+        print("Conexão de %s:%d" % peer[:2], file=sys.stderr)
+        self.expected = None
+        try:
+            while True:
+                header = HEADER.unpack(await reader.readexactly(HEADER.size))
+                if header[0] != MAGIC:
+                    print("Magic inválido, encerrando a conexão", file=sys.stderr)
+                    break
+                count = header[3]
+                values = struct.unpack("<%dH" % count, await reader.readexactly(2 * count))
+                self.frame(header, values)
+                if self.args.read_delay_ms:
+                    await asyncio.sleep(self.args.read_delay_ms / 1000.0)
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        print("Conexão de %s:%d encerrada" % peer[:2], file=sys.stderr)
+        writer.close()
+
+    async def ticker(self):
+        while True:
+            await asyncio.sleep(self.args.interval)
+            self.report()
+
+    def close(self):
+        self.report()
+        print("total: %d frames, %d capturas perdidas" % (self.total_frames, self.total_gaps), file=sys.stderr)
+        if self.out:
+            self.out.close()
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=5005)
+    parser.add_argument("--out", help="grava um frame por linha em CSV")
+    parser.add_argument("--interval", type=float, default=1.0, help="intervalo do relatório (s)")
+    parser.add_argument("--read-delay-ms", type=float, default=0.0, help="pausa após cada frame (receptor lento)")
+    return parser.parse_args()
+
+
+async def main():
+    args = parse_args()
+    listener = Listener(args)
+    server = await asyncio.start_server(listener.handle, args.host, args.port)
+    print("Aguardando o stream em %s:%d" % (args.host, args.port), file=sys.stderr)
+
+    stop = asyncio.Event()
+    loop = asyncio.get_running_loop()
+    for sig in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(sig, stop.set)
+
+    ticker = asyncio.ensure_future(listener.ticker())
+    async with server:
+        await stop.wait()
+    ticker.cancel()
+    listener.close()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())